@@ -0,0 +1,327 @@
+#include "AutoTuner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "IDataProvider.h"
+#include "IHashCalculator.h"
+#include "IPositionalDataProvider.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Calculator
+{
+
+namespace
+{
+constexpr size_t MEGABYTE = 1048576;
+/// @note Amount of data hashed in memory during calibration of hash algorithm.
+constexpr size_t HASH_CALIBRATION_BYTES = 4 * MEGABYTE;
+/// @note Amount of data read from the beginning of input file during calibration of providers.
+constexpr size_t READ_CALIBRATION_BYTES = 8 * MEGABYTE;
+/// @note Smaller reads are dominated by syscall and mapping overhead, bigger ones only cost memory.
+constexpr size_t TARGET_READ_WINDOW = 16 * MEGABYTE;
+constexpr unsigned int MAX_QUEUE_DEPTH = 64;
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(const Clock::time_point & from)
+{
+	return std::chrono::duration<double>(Clock::now() - from).count();
+}
+
+std::string HostName()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	char name[256] = {};
+	if (gethostname(name, sizeof(name) - 1) == 0 && name[0] != '\0')
+		return name;
+#else
+	if (const char * name = std::getenv("COMPUTERNAME"))
+		return name;
+#endif
+	return "localhost";
+}
+
+/// @brief Identifies storage where file is placed, so measurements of one disk are not applied to another.
+std::string DeviceId(const std::string & filePath)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	struct stat fileStat {};
+	if (stat(filePath.data(), &fileStat) == 0)
+		return std::to_string(static_cast<unsigned long long>(fileStat.st_dev));
+#else
+	(void)filePath;
+#endif
+	return "default";
+}
+
+/// @brief Asks kernel to forget cached pages, so the next read goes to the storage.
+void DropCachedRange(const std::string & filePath, size_t bytes)
+{
+#if defined(__linux__)
+	const int fileDescriptor = open(filePath.data(), O_RDONLY);
+	if (fileDescriptor < 0)
+		return;
+	posix_fadvise(fileDescriptor, 0, static_cast<off_t>(bytes), POSIX_FADV_DONTNEED);
+	close(fileDescriptor);
+#else
+	(void)filePath;
+	(void)bytes;
+#endif
+}
+
+void RunWorkers(unsigned int workers, const std::function<void()> & work)
+{
+	std::vector<std::thread> threads;
+	threads.reserve(workers);
+	for (unsigned int i = 0; i < workers; ++i)
+		threads.emplace_back(work);
+	for (std::thread & thread : threads)
+		thread.join();
+}
+
+/// @brief Reads first calibrationSize bytes of input the way workers of CalculatorManager read it.
+/// @return seconds spent.
+double TimeReads(IDataProvider & provider, size_t calibrationSize, unsigned int workers)
+{
+	const size_t chunks = (calibrationSize + MEGABYTE - 1) / MEGABYTE;
+	std::atomic<size_t> nextChunk {0};
+	std::atomic<unsigned int> checksum {0};
+	IPositionalDataProvider * positionalProvider = dynamic_cast<IPositionalDataProvider *>(&provider);
+
+	const Clock::time_point start = Clock::now();
+	if (positionalProvider && positionalProvider->ConcurrentReads())
+	{
+		// @note Every worker reads its own blocks into its own buffer, storage sees requests of all workers at once.
+		RunWorkers(workers, [&]()
+		{
+			std::vector<std::uint8_t> buffer(MEGABYTE);
+			unsigned int localChecksum = 0;
+			for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++)
+			{
+				const size_t from = chunk * MEGABYTE;
+				const size_t readBytes = positionalProvider->ReadAt(from, std::min(MEGABYTE, calibrationSize - from), buffer.data());
+				localChecksum ^= buffer[readBytes > 0 ? readBytes - 1 : 0];
+			}
+			checksum ^= localChecksum;
+		});
+	}
+	else
+	{
+		// @note Window is read by one reader, but pages of mapped window are read by workers which touch them first.
+		for (size_t windowFrom = 0; windowFrom < calibrationSize; windowFrom += TARGET_READ_WINDOW)
+		{
+			const size_t readBytes = provider.Read(windowFrom, std::min(TARGET_READ_WINDOW, calibrationSize - windowFrom));
+			const std::uint8_t * data = provider.Data();
+			nextChunk = 0;
+			RunWorkers(workers, [&]()
+			{
+				unsigned int localChecksum = 0;
+				for (size_t from = nextChunk++ * MEGABYTE; from < readBytes; from = nextChunk++ * MEGABYTE)
+					for (size_t i = from; i < std::min(from + MEGABYTE, readBytes); i += 4096)
+						localChecksum ^= data[i];
+				checksum ^= localChecksum;
+			});
+		}
+	}
+	const double elapsed = std::max(Seconds(start), 1e-6);
+	(void)checksum.load();
+	return elapsed;
+}
+} // namespace
+
+AutoTuner::AutoTuner(const std::string & profilePath)
+	: m_profilePath(profilePath)
+{
+	LoadProfile();
+}
+
+TuningResult AutoTuner::Tune(const std::string & inputFile,
+							 const std::string & algorithmName,
+							 Hash::IHashCalculator & hashCalculator,
+							 size_t blockSize,
+							 CachePolicy cachePolicy)
+{
+	if (blockSize < 1)
+		throw std::invalid_argument("Invalid block size value.");
+
+	TuningResult result;
+	const size_t fileSize = boost::filesystem::file_size(inputFile);
+	const size_t calibrationSize = std::min(fileSize, READ_CALIBRATION_BYTES);
+	const std::string deviceId = DeviceId(inputFile);
+
+	const double hashSpeed = HashSpeed(algorithmName, hashCalculator, blockSize);
+	const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	// @note Storage is measured with as many workers as the job may get, so parallel reads of pread and of mapped
+	// pages are counted.
+	double readSpeed = 0;
+	if (calibrationSize >= MEGABYTE)
+	{
+		// @note Direct reads replace any provider, so there is only one of them to measure.
+		const std::vector<ProviderType> types = cachePolicy == CachePolicy::bypass ? std::vector<ProviderType>{result.provider}
+																				   : AvailableProviderTypes();
+		for (const ProviderType type : types)
+		{
+			const double speed = ReadSpeed(inputFile, deviceId, type, cachePolicy, calibrationSize, hardwareThreads);
+			if (speed > readSpeed)
+			{
+				readSpeed = speed;
+				result.provider = type;
+			}
+		}
+	}
+
+	result.settings = DeriveSettings(hashSpeed, readSpeed, blockSize, hardwareThreads);
+
+	if (m_profileChanged)
+		SaveProfile();
+
+	return result;
+}
+
+CalculatorSettings AutoTuner::DeriveSettings(double hashSpeed, double readSpeed, size_t blockSize, unsigned int hardwareThreads)
+{
+	if (blockSize < 1)
+		throw std::invalid_argument("Invalid block size value.");
+
+	hardwareThreads = std::max(hardwareThreads, 1u);
+	unsigned int threads = hardwareThreads;
+	// @note When storage is slower than all cores together, extra workers only wait for data and fight for the lock.
+	if (hashSpeed > 0 && readSpeed > 0)
+		threads = static_cast<unsigned int>(std::clamp(std::ceil(readSpeed / hashSpeed), 1.0, static_cast<double>(hardwareThreads)));
+
+	const size_t blocksPerRead = std::max<size_t>(TARGET_READ_WINDOW / (blockSize * threads), 1);
+	CalculatorSettings settings;
+	settings.threads = threads;
+	settings.queueDepth = static_cast<unsigned int>(std::min<size_t>(blocksPerRead, MAX_QUEUE_DEPTH));
+	return settings;
+}
+
+std::string AutoTuner::DefaultProfilePath()
+{
+	boost::filesystem::path cacheDirectory;
+	if (const char * xdgCache = std::getenv("XDG_CACHE_HOME"); xdgCache != nullptr && xdgCache[0] != '\0')
+		cacheDirectory = xdgCache;
+	else if (const char * home = std::getenv("HOME"); home != nullptr && home[0] != '\0')
+		cacheDirectory = boost::filesystem::path(home) / ".cache";
+	else
+		return {};
+
+	return (cacheDirectory / "signature_generator" / (HostName() + ".profile")).string();
+}
+
+double AutoTuner::HashSpeed(const std::string & algorithmName, Hash::IHashCalculator & hashCalculator, size_t blockSize)
+{
+	const std::string key = "hash." + algorithmName + "." + std::to_string(blockSize);
+	if (const auto it = m_profile.find(key); it != m_profile.end())
+		return it->second;
+
+	std::vector<std::uint8_t> buffer(std::max(HASH_CALIBRATION_BYTES, std::min(blockSize, 4 * HASH_CALIBRATION_BYTES)));
+	std::mt19937 generator(buffer.size());
+	std::generate(buffer.begin(), buffer.end(), [&generator]() { return static_cast<std::uint8_t>(generator()); });
+
+	const size_t chunkSize = std::min(blockSize, buffer.size());
+	size_t hashedBytes = 0;
+	const Clock::time_point start = Clock::now();
+	// @note Repeat until measurement is long enough not to be ruined by timer resolution.
+	do
+	{
+		for (size_t offset = 0; offset + chunkSize <= buffer.size(); offset += chunkSize)
+		{
+			hashCalculator.CalculateHash(buffer.data() + offset, chunkSize);
+			hashedBytes += chunkSize;
+		}
+	}
+	while (Seconds(start) < 0.05);
+
+	const double speed = hashedBytes / Seconds(start);
+	m_profile[key] = speed;
+	m_profileChanged = true;
+	return speed;
+}
+
+double AutoTuner::ReadSpeed(const std::string & inputFile, const std::string & deviceId, ProviderType type, CachePolicy cachePolicy,
+							 size_t calibrationSize, unsigned int workers)
+{
+	const std::string providerName = cachePolicy == CachePolicy::bypass ? "direct" : ToString(type);
+	const std::string key = "read." + deviceId + "." + providerName + "." + std::to_string(workers);
+	if (const auto it = m_profile.find(key); it != m_profile.end())
+		return it->second;
+
+	DropCachedRange(inputFile, calibrationSize);
+
+	const std::shared_ptr<IDataProvider> provider = CreateDataProvider(type, inputFile, cachePolicy);
+	const double speed = calibrationSize / TimeReads(*provider, calibrationSize, workers);
+	m_profile[key] = speed;
+	m_profileChanged = true;
+	return speed;
+}
+
+void AutoTuner::LoadProfile()
+{
+	if (m_profilePath.empty())
+		return;
+
+	std::ifstream profile(m_profilePath);
+	std::string line;
+	while (std::getline(profile, line))
+	{
+		const size_t separator = line.find('=');
+		if (separator == std::string::npos)
+			continue;
+
+		// @note Broken line is measured again and rewritten.
+		try
+		{
+			const std::string value = line.substr(separator + 1);
+			size_t parsed = 0;
+			const double speed = std::stod(value, &parsed);
+			if (parsed == value.size() && std::isfinite(speed) && speed > 0)
+				m_profile[line.substr(0, separator)] = speed;
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+}
+
+void AutoTuner::SaveProfile() const
+{
+	if (m_profilePath.empty())
+		return;
+
+	const boost::filesystem::path profilePath(m_profilePath);
+	boost::system::error_code error;
+	if (profilePath.has_parent_path())
+		boost::filesystem::create_directories(profilePath.parent_path(), error);
+
+	// @note Profile is replaced by rename, so concurrent runs never see half written file.
+	const std::string temporaryPath = m_profilePath + boost::filesystem::unique_path(".%%%%%%.tmp").string();
+	{
+		std::ofstream profile(temporaryPath, std::ios_base::trunc);
+		if (!profile.is_open())
+			return;
+		profile.precision(17);
+		for (const auto & [key, value] : m_profile)
+			profile << key << '=' << value << '\n';
+	}
+	boost::filesystem::rename(temporaryPath, profilePath, error);
+}
+
+} // namespace Calculator
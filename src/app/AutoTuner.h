@@ -0,0 +1,60 @@
+#ifndef AUTO_TUNER_H
+#define AUTO_TUNER_H
+
+#include <map>
+#include <string>
+
+#include "DataProviderFactory.h"
+#include "SignatureCalculator.h"
+
+namespace Hash { class IHashCalculator; }
+
+namespace Calculator
+{
+
+struct TuningResult
+{
+	CalculatorSettings settings;
+	ProviderType provider {AvailableProviderTypes().front()};
+};
+
+/// @brief Chooses number of workers, read window depth and data provider for current host.
+/// Speed of hash algorithm and speed of storage are measured once and cached in profile file,
+/// so only first run on the host (or on a new storage device) pays for calibration.
+class AutoTuner
+{
+public:
+	/// @param profilePath file with cached measurements. Empty path disables caching.
+	explicit AutoTuner(const std::string & profilePath);
+
+	/// @param cachePolicy policy the job reads input with, bypass is measured with direct reads.
+	TuningResult Tune(const std::string & inputFile,
+					  const std::string & algorithmName,
+					  Hash::IHashCalculator & hashCalculator,
+					  size_t blockSize,
+					  CachePolicy cachePolicy = CachePolicy::keep);
+
+	/// @brief Derives number of workers and read window depth from measured speeds.
+	/// @param hashSpeed bytes per second hashed by one worker, zero if unknown.
+	/// @param readSpeed bytes per second read by all workers together, zero if unknown.
+	static CalculatorSettings DeriveSettings(double hashSpeed, double readSpeed, size_t blockSize, unsigned int hardwareThreads);
+
+	/// @brief Returns per-host profile path in user cache directory or empty string if there is no such directory.
+	static std::string DefaultProfilePath();
+
+private:
+	double HashSpeed(const std::string & algorithmName, Hash::IHashCalculator & hashCalculator, size_t blockSize);
+	double ReadSpeed(const std::string & inputFile, const std::string & deviceId, ProviderType type, CachePolicy cachePolicy,
+					 size_t calibrationSize, unsigned int workers);
+
+	void LoadProfile();
+	void SaveProfile() const;
+
+	const std::string m_profilePath;
+	std::map<std::string, double> m_profile;
+	bool m_profileChanged {false};
+};
+
+} // namespace Calculator
+
+#endif
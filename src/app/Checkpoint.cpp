@@ -0,0 +1,216 @@
+#include "Checkpoint.h"
+
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "FileHashSaver.h"
+#include "PositionalHashSaver.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Calculator
+{
+
+namespace
+{
+void SyncPath(const std::string & path)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	const int fileDescriptor = open(path.data(), O_RDONLY);
+	if (fileDescriptor < 0)
+		throw std::runtime_error("Cannot open: " + path + "; for sync.");
+	const int result = fsync(fileDescriptor);
+	close(fileDescriptor);
+	if (result != 0)
+		throw std::runtime_error("Cannot sync: " + path + " with error: " + std::to_string(errno));
+#else
+	(void)path;
+#endif
+}
+
+/// @return nanoseconds since epoch.
+std::int64_t ModificationTime(const std::string & path)
+{
+#if defined(__linux__)
+	struct stat status {};
+	if (stat(path.data(), &status) != 0)
+		throw std::runtime_error("Cannot get modification time of file: " + path);
+	return static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+	struct stat status {};
+	if (stat(path.data(), &status) != 0)
+		throw std::runtime_error("Cannot get modification time of file: " + path);
+	return static_cast<std::int64_t>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+	return static_cast<std::int64_t>(boost::filesystem::last_write_time(path)) * 1000000000;
+#endif
+}
+} // namespace
+
+bool CheckpointState::SameJob(const CheckpointState & other) const
+{
+	return inputSize == other.inputSize
+		&& inputModificationTime == other.inputModificationTime
+		&& blockSize == other.blockSize
+		&& algorithm == other.algorithm
+		&& shardFirstBlock == other.shardFirstBlock
+		&& shardEndBlock == other.shardEndBlock;
+}
+
+Checkpoint::Checkpoint(const std::string & outputFile)
+	: m_path(outputFile + ".checkpoint")
+{
+}
+
+CheckpointState Checkpoint::Describe(const std::string & inputFile, std::uint64_t blockSize, const std::string & algorithm)
+{
+	CheckpointState state;
+	state.inputSize = boost::filesystem::file_size(inputFile);
+	state.inputModificationTime = ModificationTime(inputFile);
+	state.blockSize = blockSize;
+	state.algorithm = algorithm;
+	return state;
+}
+
+std::optional<CheckpointState> Checkpoint::Load() const
+{
+	std::ifstream file(m_path);
+	if (!file.is_open())
+		return std::nullopt;
+
+	std::map<std::string, std::string> values;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const size_t separator = line.find('=');
+		if (separator != std::string::npos)
+			values[line.substr(0, separator)] = line.substr(separator + 1);
+	}
+
+	const auto value = [this, &values](const std::string & key) -> const std::string &
+	{
+		const auto it = values.find(key);
+		if (it == values.end())
+			throw std::runtime_error("Checkpoint: " + m_path + " is broken, missing " + key + ".");
+		return it->second;
+	};
+
+	CheckpointState state;
+	state.nextBlock = std::stoull(value("next_block"));
+	state.outputSize = std::stoull(value("output_size"));
+	state.inputSize = std::stoull(value("input_size"));
+	state.inputModificationTime = std::stoll(value("input_mtime"));
+	state.blockSize = std::stoull(value("block_size"));
+	state.algorithm = value("algorithm");
+	// @note Checkpoints of whole file jobs may have no shard range.
+	if (values.count("shard_first_block"))
+		state.shardFirstBlock = std::stoull(values["shard_first_block"]);
+	if (values.count("shard_end_block"))
+		state.shardEndBlock = std::stoull(values["shard_end_block"]);
+	return state;
+}
+
+void Checkpoint::Save(const CheckpointState & state) const
+{
+	const std::string temporaryPath = m_path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios_base::trunc);
+		file << "next_block=" << state.nextBlock << '\n'
+			 << "output_size=" << state.outputSize << '\n'
+			 << "input_size=" << state.inputSize << '\n'
+			 << "input_mtime=" << state.inputModificationTime << '\n'
+			 << "block_size=" << state.blockSize << '\n'
+			 << "algorithm=" << state.algorithm << '\n'
+			 << "shard_first_block=" << state.shardFirstBlock << '\n'
+			 << "shard_end_block=" << state.shardEndBlock << '\n';
+		file.flush();
+		if (!file)
+			throw std::runtime_error("Cannot write checkpoint: " + temporaryPath);
+	}
+
+	// @note Rename is atomic, so after crash there is either old or new checkpoint, never a torn one.
+	SyncPath(temporaryPath);
+	boost::filesystem::rename(temporaryPath, m_path);
+
+	const boost::filesystem::path directory = boost::filesystem::absolute(m_path).parent_path();
+	SyncPath(directory.string());
+}
+
+void Checkpoint::Remove() const
+{
+	boost::system::error_code error;
+	boost::filesystem::remove(m_path, error);
+}
+
+const std::string & Checkpoint::Path() const
+{
+	return m_path;
+}
+
+CheckpointedOutput OpenCheckpointedOutput(const Checkpoint & checkpoint, const CheckpointState & jobState, bool resume,
+										  const std::string & outputFile, const std::string & header, size_t digestLength,
+										  std::chrono::seconds interval)
+{
+	std::optional<CheckpointState> resumeState;
+	if (resume)
+	{
+		resumeState = checkpoint.Load();
+		if (resumeState && !resumeState->SameJob(jobState))
+			throw std::runtime_error("Checkpoint: " + checkpoint.Path() + " was made for another input file or parameters.");
+	}
+	else
+	{
+		// @note Stale checkpoint of another run must not be applied to the new output.
+		checkpoint.Remove();
+	}
+
+	CheckpointedOutput output;
+	output.resumed = resumeState.has_value();
+	output.firstBlock = resumeState ? resumeState->nextBlock : jobState.shardFirstBlock;
+
+	std::function<std::uint64_t(size_t)> outputSize;
+	if (digestLength > 0)
+	{
+		const auto positionalHashSaver = std::make_shared<PositionalHashSaver>(outputFile, digestLength, header,
+																			   jobState.shardFirstBlock, output.resumed);
+		output.hashSaver = positionalHashSaver;
+		outputSize = [positionalHashSaver](size_t nextBlock) { return positionalHashSaver->Size(nextBlock); };
+	}
+	else
+	{
+		const std::shared_ptr<FileHashSaver> fileHashSaver = resumeState ? std::make_shared<FileHashSaver>(outputFile, resumeState->outputSize)
+																		 : std::make_shared<FileHashSaver>(outputFile);
+		output.hashSaver = fileHashSaver;
+		outputSize = [fileHashSaver](size_t) { return fileHashSaver->Size(); };
+		// @note Resumed output already starts with the header.
+		if (!header.empty() && !resumeState)
+			fileHashSaver->Save(header);
+	}
+
+	output.onCommitted = [checkpoint, jobState, hashSaver = output.hashSaver, outputSize, interval,
+						  lastCheckpoint = std::chrono::steady_clock::now()](size_t nextBlock) mutable
+	{
+		const auto now = std::chrono::steady_clock::now();
+		if (now - lastCheckpoint < interval)
+			return;
+
+		// @note Output must reach the disk before checkpoint which points to it. Positional output may already hold
+		// digests after nextBlock, they are written again by resumed run.
+		hashSaver->Sync();
+		CheckpointState state = jobState;
+		state.nextBlock = nextBlock;
+		state.outputSize = outputSize(nextBlock);
+		checkpoint.Save(state);
+		lastCheckpoint = now;
+	};
+	return output;
+}
+
+} // namespace Calculator
@@ -0,0 +1,83 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "IHashSaver.h"
+
+namespace Calculator
+{
+
+/// @brief Durable progress of the signature job.
+struct CheckpointState
+{
+	/// @brief All blocks before this one are hashed and durably saved.
+	std::uint64_t nextBlock {0};
+	/// @brief Size of the output which belongs to blocks before nextBlock.
+	std::uint64_t outputSize {0};
+
+	/// @note Input and job parameters, checkpoint is valid only for exactly the same job.
+	std::uint64_t inputSize {0};
+	/// @brief Nanoseconds since epoch, input rewritten within the same second is a different input.
+	std::int64_t inputModificationTime {0};
+	std::uint64_t blockSize {0};
+	std::string algorithm;
+	/// @brief Range of blocks hashed by sharded job, zero end block means the whole input.
+	std::uint64_t shardFirstBlock {0};
+	std::uint64_t shardEndBlock {0};
+
+	bool SameJob(const CheckpointState & other) const;
+};
+
+/// @brief Checkpoint file placed next to the output file.
+class Checkpoint
+{
+public:
+	explicit Checkpoint(const std::string & outputFile);
+
+	/// @brief Fills input and job part of the state from current input file.
+	static CheckpointState Describe(const std::string & inputFile, std::uint64_t blockSize, const std::string & algorithm);
+
+	/// @return empty value if there is no checkpoint.
+	/// @note Throws exception if checkpoint exists but cannot be parsed.
+	std::optional<CheckpointState> Load() const;
+	/// @brief Atomically replaces checkpoint and waits until it reaches the disk.
+	void Save(const CheckpointState & state) const;
+	void Remove() const;
+
+	const std::string & Path() const;
+
+private:
+	const std::string m_path;
+};
+
+/// @brief Output of the job which may be interrupted and continued later.
+struct CheckpointedOutput
+{
+	std::shared_ptr<IHashSaver> hashSaver;
+	/// @brief Block the job starts from, digests of blocks before it are already in the output.
+	std::uint64_t firstBlock {0};
+	/// @brief Output is continued from the checkpoint.
+	bool resumed {false};
+	/// @brief Syncs output and saves checkpoint at most once per interval, suits CalculatorSettings::onCommitted.
+	std::function<void(size_t)> onCommitted;
+};
+
+/// @brief Opens output of the job described by jobState, continues it from the checkpoint if resume is requested.
+/// @param header written before digests of new output, shard header or empty string.
+/// @param digestLength length of every digest for positional output, zero for sequential output.
+/// @param interval minimal time between checkpoints.
+/// @note Throws exception if checkpoint was made for another job. Checkpoint is removed if resume is not requested.
+CheckpointedOutput OpenCheckpointedOutput(const Checkpoint & checkpoint, const CheckpointState & jobState, bool resume,
+										  const std::string & outputFile, const std::string & header, size_t digestLength,
+										  std::chrono::seconds interval);
+
+} // namespace Calculator
+
+#endif
@@ -0,0 +1,505 @@
+#include "SignatureDaemon.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include "DataProviderFactory.h"
+#include "SignatureEngine.h"
+
+#include "FileHashSaver.h"
+#include "IHashSaver.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <sys/stat.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+namespace Calculator
+{
+
+const std::string SignatureJob::INLINE_OUTPUT = "-";
+
+namespace
+{
+/// @note Period of checking for stop request while there are no clients.
+constexpr int ACCEPT_POLL_INTERVAL_MS = 200;
+/// @note Period of checking whether client of the job in progress is still connected.
+constexpr int CLIENT_POLL_INTERVAL_MS = 100;
+/// @note Request is a few short lines, anything bigger is not a request.
+constexpr size_t MAX_REQUEST_SIZE = 65536;
+
+const std::string INPUT_FILE_FIELD = "input_file";
+const std::string OUTPUT_FILE_FIELD = "output_file";
+const std::string BLOCK_SIZE_FIELD = "block_size";
+const std::string ALGORITHM_FIELD = "algorithm";
+
+/// @brief Keeps signature returned inline in memory.
+class MemoryHashSaver : public IHashSaver
+{
+public:
+	void Save(const std::string & hash) override { m_data += hash; }
+	void Sync() override {}
+
+	const std::string & Data() const { return m_data; }
+
+private:
+	std::string m_data;
+};
+
+#if !defined(_WIN32) && !defined(_WIN64)
+sockaddr_un SocketAddress(const std::string & socketPath)
+{
+	sockaddr_un address {};
+	address.sun_family = AF_UNIX;
+	if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path))
+		throw std::invalid_argument("Invalid socket path: " + socketPath);
+	std::memcpy(address.sun_path, socketPath.data(), socketPath.size());
+	return address;
+}
+
+int OpenSocket()
+{
+	const int socketDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socketDescriptor < 0)
+		throw std::runtime_error("Cannot create socket with error: " + std::to_string(errno));
+#ifdef SO_NOSIGPIPE
+	const int enabled = 1;
+	setsockopt(socketDescriptor, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+	return socketDescriptor;
+}
+
+/// @return false if nobody listens on the socket.
+bool Connect(int socketDescriptor, const std::string & socketPath)
+{
+	const sockaddr_un address = SocketAddress(socketPath);
+	return connect(socketDescriptor, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+}
+
+void SendAll(int socketDescriptor, const std::string & data)
+{
+#ifdef MSG_NOSIGNAL
+	constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+	constexpr int SEND_FLAGS = 0;
+#endif
+	for (size_t sent = 0; sent < data.size(); )
+	{
+		const ssize_t result = send(socketDescriptor, data.data() + sent, data.size() - sent, SEND_FLAGS);
+		if (result < 0 && errno == EINTR)
+			continue;
+		if (result <= 0)
+			throw std::runtime_error("Cannot send to socket with error: " + std::to_string(errno));
+		sent += static_cast<size_t>(result);
+	}
+}
+
+/// @brief Waits up to timeout for the client to close connection.
+/// @note Client sends nothing after request, anything it sends is discarded.
+bool ClientClosed(int socketDescriptor, int timeoutMs)
+{
+	pollfd connection {socketDescriptor, POLLIN, 0};
+	if (poll(&connection, 1, timeoutMs) <= 0)
+		return false;
+	if (connection.revents & (POLLHUP | POLLERR))
+		return true;
+
+	char chunk[4096];
+	const ssize_t result = recv(socketDescriptor, chunk, sizeof(chunk), MSG_DONTWAIT);
+	return result == 0 || (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+/// @brief Buffered reading of lines and raw data from the socket.
+class SocketReader
+{
+public:
+	explicit SocketReader(int socketDescriptor)
+		: m_socket(socketDescriptor)
+	{}
+
+	/// @return false if connection is closed before the end of the line.
+	bool ReadLine(std::string & line)
+	{
+		size_t end = m_buffer.find('\n');
+		while (end == std::string::npos)
+		{
+			if (m_buffer.size() > MAX_REQUEST_SIZE || !Receive())
+				return false;
+			end = m_buffer.find('\n');
+		}
+		line = m_buffer.substr(0, end);
+		m_buffer.erase(0, end + 1);
+		return true;
+	}
+
+	/// @return false if connection is closed before all bytes are received.
+	bool Read(size_t bytes, std::string & data)
+	{
+		while (m_buffer.size() < bytes)
+			if (!Receive())
+				return false;
+		data = m_buffer.substr(0, bytes);
+		m_buffer.erase(0, bytes);
+		return true;
+	}
+
+private:
+	bool Receive()
+	{
+		char chunk[65536];
+		ssize_t result = 0;
+		do
+		{
+			result = recv(m_socket, chunk, sizeof(chunk), 0);
+		} while (result < 0 && errno == EINTR);
+		if (result <= 0)
+			return false;
+		m_buffer.append(chunk, static_cast<size_t>(result));
+		return true;
+	}
+
+	const int m_socket;
+	std::string m_buffer;
+};
+#endif
+} // namespace
+
+std::string FormatJobRequest(const SignatureJob & job)
+{
+	for (const std::string * field : {&job.inputFile, &job.outputFile, &job.algorithm})
+		if (field->find('\n') != std::string::npos)
+			throw std::invalid_argument("Job parameters must not contain new lines.");
+
+	return INPUT_FILE_FIELD + "=" + job.inputFile + "\n"
+		   + OUTPUT_FILE_FIELD + "=" + job.outputFile + "\n"
+		   + BLOCK_SIZE_FIELD + "=" + std::to_string(job.blockSize) + "\n"
+		   + ALGORITHM_FIELD + "=" + job.algorithm + "\n"
+		   + "\n";
+}
+
+SignatureJob ParseJobRequest(const std::string & request)
+{
+	std::map<std::string, std::string> values;
+	std::istringstream lines(request);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		const size_t separator = line.find('=');
+		if (separator == std::string::npos || separator == 0)
+			throw std::invalid_argument("Malformed request line: " + line);
+		if (!values.emplace(line.substr(0, separator), line.substr(separator + 1)).second)
+			throw std::invalid_argument("Request has duplicate " + line.substr(0, separator) + ".");
+	}
+
+	const auto value = [&values](const std::string & key) -> const std::string &
+	{
+		const auto it = values.find(key);
+		if (it == values.end() || it->second.empty())
+			throw std::invalid_argument("Request has no " + key + ".");
+		return it->second;
+	};
+
+	SignatureJob job;
+	job.inputFile = value(INPUT_FILE_FIELD);
+	job.outputFile = value(OUTPUT_FILE_FIELD);
+	job.algorithm = value(ALGORITHM_FIELD);
+
+	const std::string & blockSize = value(BLOCK_SIZE_FIELD);
+	if (!std::all_of(blockSize.begin(), blockSize.end(), [](unsigned char symbol) { return std::isdigit(symbol); }))
+		throw std::invalid_argument("Invalid block size: " + blockSize);
+	try
+	{
+		job.blockSize = std::stoull(blockSize);
+	}
+	catch (const std::exception &)
+	{
+		throw std::invalid_argument("Invalid block size: " + blockSize);
+	}
+	if (job.blockSize < 1)
+		throw std::invalid_argument("Invalid block size: " + blockSize);
+	if (job.algorithm != "md5" && job.algorithm != "crc")
+		throw std::invalid_argument("Unknown algorithm: " + job.algorithm);
+	return job;
+}
+
+struct SignatureDaemon::Client
+{
+	/// @note Closed socket is reset under mutex of clients, so daemon never shuts down descriptor reused by someone else.
+	int socket {-1};
+	/// @brief Request is received and job is started, such client is not disconnected when daemon stops.
+	bool running {false};
+	std::thread thread;
+	std::atomic_bool finished {false};
+};
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+SignatureDaemon::SignatureDaemon(const std::string & socketPath, unsigned int threads, size_t maxClients)
+	: m_socketPath(socketPath)
+	, m_maxClients(maxClients)
+{
+	const sockaddr_un address = SocketAddress(m_socketPath);
+	if (m_maxClients == 0)
+		throw std::invalid_argument("Daemon must serve at least one client.");
+
+	// @note Socket file left by crashed daemon is replaced, socket of running one is not.
+	struct stat socketStat {};
+	if (lstat(m_socketPath.data(), &socketStat) == 0)
+	{
+		if (!S_ISSOCK(socketStat.st_mode))
+			throw std::runtime_error("Path: " + m_socketPath + " exists and is not a socket.");
+
+		const int probe = OpenSocket();
+		const bool running = Connect(probe, m_socketPath);
+		close(probe);
+		if (running)
+			throw std::runtime_error("Daemon is already running on: " + m_socketPath);
+		unlink(m_socketPath.data());
+	}
+
+	m_engine = std::make_unique<SignatureEngine>(threads);
+
+	m_socket = OpenSocket();
+	// @note Only the owner may connect, jobs read and write files with permissions of the daemon.
+	const mode_t previousMask = umask(0077);
+	const int bindResult = bind(m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+	umask(previousMask);
+	if (bindResult != 0 || listen(m_socket, SOMAXCONN) != 0)
+	{
+		const int error = errno;
+		close(m_socket);
+		throw std::runtime_error("Cannot listen on: " + m_socketPath + " with error: " + std::to_string(error));
+	}
+}
+
+SignatureDaemon::~SignatureDaemon()
+{
+	Stop();
+	ReapClients(true);
+	close(m_socket);
+	unlink(m_socketPath.data());
+}
+
+void SignatureDaemon::Run()
+{
+	while (!m_stopExecution)
+	{
+		// @note Clients over the limit wait in the queue of the socket until one of served clients is gone.
+		const bool full = ReapClients(false) >= m_maxClients;
+		pollfd listening {m_socket, static_cast<short>(full ? 0 : POLLIN), 0};
+		const int ready = poll(&listening, 1, ACCEPT_POLL_INTERVAL_MS);
+		if (ready <= 0 || full || m_stopExecution)
+			continue;
+
+		const int connection = accept(m_socket, nullptr, nullptr);
+		if (connection < 0)
+			continue;
+
+		auto client = std::make_unique<Client>();
+		client->socket = connection;
+		std::lock_guard<std::mutex> lock(m_clientsMutex);
+		Client & started = *client;
+		m_clients.push_back(std::move(client));
+		started.thread = std::thread(&SignatureDaemon::ServeClient, this, std::ref(started));
+	}
+
+	// @note Clients which have not sent request yet are disconnected, jobs in progress are completed.
+	{
+		std::lock_guard<std::mutex> lock(m_clientsMutex);
+		for (const std::unique_ptr<Client> & client : m_clients)
+			if (client->socket >= 0 && !client->running)
+				shutdown(client->socket, SHUT_RD);
+	}
+	ReapClients(true);
+}
+
+void SignatureDaemon::Stop()
+{
+	m_stopExecution = true;
+}
+
+void SignatureDaemon::ServeClient(Client & client)
+{
+	SocketReader reader(client.socket);
+	try
+	{
+		std::string request;
+		std::string line;
+		while (true)
+		{
+			if (!reader.ReadLine(line))
+				throw std::runtime_error("Incomplete request.");
+			if (line.empty())
+				break;
+			request += line + "\n";
+		}
+
+		const SignatureJob job = ParseJobRequest(request);
+		if (IsStreamInput(job.inputFile))
+			throw std::invalid_argument("Stream input: " + job.inputFile + " cannot be read by daemon.");
+		{
+			// @note Daemon which is stopping has already disconnected clients without jobs, so it takes no new ones.
+			std::lock_guard<std::mutex> lock(m_clientsMutex);
+			if (m_stopExecution)
+				throw std::runtime_error("Daemon is stopping.");
+			client.running = true;
+		}
+
+		const bool inlineOutput = job.outputFile == SignatureJob::INLINE_OUTPUT;
+		const std::shared_ptr<MemoryHashSaver> memoryHashSaver = inlineOutput ? std::make_shared<MemoryHashSaver>() : nullptr;
+		const std::shared_ptr<IHashSaver> hashSaver = inlineOutput ? std::shared_ptr<IHashSaver>(memoryHashSaver)
+																   : std::make_shared<FileHashSaver>(job.outputFile);
+
+		const std::unique_ptr<SignatureTask> task = m_engine->SubmitFile(job.inputFile, job.blockSize, CreateHashCalculator(job.algorithm),
+			[&hashSaver](std::uint64_t, const std::string & digest) { hashSaver->Save(digest); });
+		// @note Job of the client which is gone would only take workers from other jobs.
+		while (!task->Finished())
+		{
+			if (ClientClosed(client.socket, CLIENT_POLL_INTERVAL_MS))
+			{
+				task->Cancel();
+				break;
+			}
+		}
+		task->Wait();
+		if (task->Cancelled())
+			throw std::runtime_error("Client disconnected, job is cancelled.");
+		hashSaver->Sync();
+
+		const std::string signature = inlineOutput ? memoryHashSaver->Data() : std::string();
+		SendAll(client.socket, "ok " + std::to_string(signature.size()) + "\n" + signature);
+	}
+	catch (const std::exception & ex)
+	{
+		try
+		{
+			std::string message = ex.what();
+			for (char & symbol : message)
+				if (symbol == '\n')
+					symbol = ' ';
+			SendAll(client.socket, "error " + message + "\n");
+		}
+		catch (const std::exception &)
+		{
+			// @note Client is gone, there is nobody to report to.
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_clientsMutex);
+		close(client.socket);
+		client.socket = -1;
+	}
+	client.finished = true;
+}
+
+size_t SignatureDaemon::ReapClients(bool all)
+{
+	std::lock_guard<std::mutex> lock(m_clientsMutex);
+	for (auto it = m_clients.begin(); it != m_clients.end(); )
+	{
+		Client & client = **it;
+		if (!all && !client.finished)
+		{
+			++it;
+			continue;
+		}
+		if (client.thread.joinable())
+			client.thread.join();
+		it = m_clients.erase(it);
+	}
+	return m_clients.size();
+}
+
+DaemonClient::DaemonClient(const std::string & socketPath)
+	: m_socket(OpenSocket())
+{
+	if (!Connect(m_socket, socketPath))
+	{
+		const int error = errno;
+		close(m_socket);
+		throw std::system_error(error, std::generic_category(), "Cannot connect to daemon: " + socketPath);
+	}
+}
+
+DaemonClient::~DaemonClient()
+{
+	close(m_socket);
+}
+
+std::string DaemonClient::Run(const SignatureJob & job)
+{
+	SendAll(m_socket, FormatJobRequest(job));
+
+	SocketReader reader(m_socket);
+	std::string status;
+	if (!reader.ReadLine(status))
+		throw std::runtime_error("Daemon closed connection without response.");
+
+	const std::string OK_STATUS = "ok ";
+	const std::string ERROR_STATUS = "error ";
+	if (status.compare(0, ERROR_STATUS.size(), ERROR_STATUS) == 0)
+		throw std::runtime_error("Daemon failed job: " + status.substr(ERROR_STATUS.size()));
+	if (status.compare(0, OK_STATUS.size(), OK_STATUS) != 0)
+		throw std::runtime_error("Unexpected daemon response: " + status);
+
+	std::string signature;
+	if (!reader.Read(std::stoull(status.substr(OK_STATUS.size())), signature))
+		throw std::runtime_error("Daemon closed connection before the end of signature.");
+	return signature;
+}
+
+#else
+
+SignatureDaemon::SignatureDaemon(const std::string &, unsigned int, size_t)
+	: m_maxClients(0)
+{
+	throw std::runtime_error("Daemon is not supported on this platform.");
+}
+
+SignatureDaemon::~SignatureDaemon() = default;
+void SignatureDaemon::Run() {}
+void SignatureDaemon::Stop() {}
+void SignatureDaemon::ServeClient(Client &) {}
+size_t SignatureDaemon::ReapClients(bool) { return 0; }
+
+DaemonClient::DaemonClient(const std::string & socketPath)
+{
+	throw std::system_error(std::make_error_code(std::errc::not_supported), "Cannot connect to daemon: " + socketPath);
+}
+
+DaemonClient::~DaemonClient() = default;
+
+std::string DaemonClient::Run(const SignatureJob &)
+{
+	return std::string();
+}
+
+#endif
+
+std::optional<std::string> RunByDaemon(const std::string & socketPath, const SignatureJob & job, bool daemonRequired)
+{
+	std::unique_ptr<DaemonClient> client;
+	try
+	{
+		client = std::make_unique<DaemonClient>(socketPath);
+	}
+	catch (const std::system_error &)
+	{
+		if (daemonRequired)
+			throw;
+		return std::nullopt;
+	}
+	return client->Run(job);
+}
+
+} // namespace Calculator
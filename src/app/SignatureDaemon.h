@@ -0,0 +1,107 @@
+#ifndef SIGNATURE_DAEMON_H
+#define SIGNATURE_DAEMON_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace Calculator
+{
+
+class SignatureEngine;
+
+/// @brief Signature job sent to the daemon.
+/// Request is a set of key=value lines terminated by an empty line. Response starts with "ok <size>" line followed by
+/// size bytes of signature returned inline, or with "error <message>" line.
+struct SignatureJob
+{
+	/// @note Paths are resolved by the daemon, so they must be absolute.
+	std::string inputFile;
+	/// @brief Signature is returned inline instead of being written if output is INLINE_OUTPUT.
+	std::string outputFile;
+	size_t blockSize {0};
+	std::string algorithm;
+
+	static const std::string INLINE_OUTPUT;
+};
+
+/// @brief Returns request of the job including terminating empty line.
+/// @note Throws exception if job parameters contain new lines.
+std::string FormatJobRequest(const SignatureJob & job);
+/// @brief Parses request lines without terminating empty line.
+/// @note Throws std::invalid_argument if request is malformed, lacks parameters or has invalid ones.
+SignatureJob ParseJobRequest(const std::string & request);
+
+/// @brief Serves signature jobs of local clients on one set of already running hash workers.
+/// @note Every client connection is served by its own thread, workers are shared by all jobs in turn.
+/// Job of the client which disconnects is cancelled.
+class SignatureDaemon
+{
+public:
+	static constexpr size_t DEFAULT_MAX_CLIENTS = 64;
+
+	/// @param threads number of hash workers, zero means one worker per hardware thread.
+	/// @param maxClients number of clients served at once, others wait in the queue of the socket.
+	/// @note Throws exception if socket is used by another running daemon.
+	SignatureDaemon(const std::string & socketPath, unsigned int threads, size_t maxClients = DEFAULT_MAX_CLIENTS);
+	~SignatureDaemon();
+
+	SignatureDaemon(const SignatureDaemon &) = delete;
+	SignatureDaemon & operator=(const SignatureDaemon &) = delete;
+
+	/// @brief Accepts clients until Stop() is called, then waits for jobs in progress.
+	void Run();
+	/// @note Safe to call from signal handler.
+	void Stop();
+
+private:
+	struct Client;
+
+	void ServeClient(Client & client);
+	/// @brief Joins threads of served clients.
+	/// @return number of clients still being served.
+	size_t ReapClients(bool all);
+
+	const std::string m_socketPath;
+	const size_t m_maxClients;
+	std::unique_ptr<SignatureEngine> m_engine;
+	int m_socket {-1};
+	std::atomic_bool m_stopExecution {false};
+
+	std::mutex m_clientsMutex;
+	std::list<std::unique_ptr<Client>> m_clients;
+};
+
+/// @brief Connection of the client to the running daemon.
+class DaemonClient
+{
+public:
+	/// @note Throws std::system_error if there is no daemon listening on the socket.
+	explicit DaemonClient(const std::string & socketPath);
+	~DaemonClient();
+
+	DaemonClient(const DaemonClient &) = delete;
+	DaemonClient & operator=(const DaemonClient &) = delete;
+
+	/// @brief Runs job and waits for its completion.
+	/// @return signature if it is requested inline, empty string otherwise.
+	/// @note Throws exception if daemon fails the job.
+	std::string Run(const SignatureJob & job);
+
+private:
+	int m_socket {-1};
+};
+
+/// @brief Runs job by daemon listening on the socket.
+/// @param daemonRequired throw exception instead of returning empty value if there is no daemon.
+/// @return signature as DaemonClient::Run does, empty value if there is no daemon and job must be run locally.
+std::optional<std::string> RunByDaemon(const std::string & socketPath, const SignatureJob & job, bool daemonRequired);
+
+} // namespace Calculator
+
+#endif
@@ -0,0 +1,181 @@
+#include "SignatureShard.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "Checkpoint.h"
+
+namespace Calculator
+{
+
+namespace
+{
+const std::string SHARD_MARKER = "#shard";
+
+struct Shard
+{
+	std::string path;
+	ShardHeader header;
+	/// @note Position of the first hash in the shard file.
+	std::uint64_t payloadOffset {0};
+	std::uint64_t payloadSize {0};
+};
+
+Shard OpenShard(const std::string & path)
+{
+	std::ifstream file(path, std::ios_base::binary);
+	if (!file.is_open())
+		throw std::runtime_error("Cannot open shard: " + path);
+
+	std::string line;
+	if (!std::getline(file, line) || file.eof())
+		throw std::runtime_error("Shard: " + path + " has no header.");
+
+	Shard shard;
+	shard.path = path;
+	try
+	{
+		shard.header = ParseShardHeader(line);
+	}
+	catch (const std::exception & ex)
+	{
+		throw std::runtime_error("Shard: " + path + " " + ex.what());
+	}
+	shard.payloadOffset = line.size() + 1;
+	shard.payloadSize = boost::filesystem::file_size(path) - shard.payloadOffset;
+	return shard;
+}
+} // namespace
+
+size_t DigestLength(const std::string & algorithm)
+{
+	// @note Hex form of 16 bytes of md5 or 4 bytes of crc.
+	if (algorithm == "md5")
+		return 32;
+	if (algorithm == "crc")
+		return 8;
+	return 0;
+}
+
+std::string FormatShardHeader(const ShardHeader & header)
+{
+	std::ostringstream stream;
+	stream << SHARD_MARKER
+		   << " algorithm=" << header.algorithm
+		   << " block_size=" << header.blockSize
+		   << " first_block=" << header.firstBlock
+		   << " block_count=" << header.blockCount
+		   << " total_blocks=" << header.totalBlocks
+		   << " input_size=" << header.inputSize
+		   << " input_mtime=" << header.inputModificationTime
+		   << '\n';
+	return stream.str();
+}
+
+ShardHeader ParseShardHeader(const std::string & line)
+{
+	std::istringstream stream(line);
+	std::string marker;
+	if (!(stream >> marker) || marker != SHARD_MARKER)
+		throw std::invalid_argument("is not a shard header.");
+
+	std::map<std::string, std::string> values;
+	std::string field;
+	while (stream >> field)
+	{
+		const size_t separator = field.find('=');
+		if (separator != std::string::npos)
+			values[field.substr(0, separator)] = field.substr(separator + 1);
+	}
+
+	const auto value = [&values](const std::string & key) -> const std::string &
+	{
+		const auto it = values.find(key);
+		if (it == values.end() || it->second.empty())
+			throw std::invalid_argument("has broken header, missing " + key + ".");
+		return it->second;
+	};
+
+	ShardHeader header;
+	header.algorithm = value("algorithm");
+	header.blockSize = std::stoull(value("block_size"));
+	header.firstBlock = std::stoull(value("first_block"));
+	header.blockCount = std::stoull(value("block_count"));
+	header.totalBlocks = std::stoull(value("total_blocks"));
+	header.inputSize = std::stoull(value("input_size"));
+	header.inputModificationTime = std::stoll(value("input_mtime"));
+	if (header.blockSize == 0 || header.firstBlock + header.blockCount > header.totalBlocks)
+		throw std::invalid_argument("has inconsistent header.");
+	return header;
+}
+
+void MergeShards(const std::vector<std::string> & shardFiles, const std::string & outputFile)
+{
+	if (shardFiles.empty())
+		throw std::invalid_argument("No shards to merge.");
+
+	std::vector<Shard> shards;
+	shards.reserve(shardFiles.size());
+	for (const std::string & path : shardFiles)
+		shards.push_back(OpenShard(path));
+
+	std::sort(shards.begin(), shards.end(), [](const Shard & left, const Shard & right)
+	{
+		return left.header.firstBlock < right.header.firstBlock;
+	});
+
+	const ShardHeader & job = shards.front().header;
+	const std::uint64_t digestLength = DigestLength(job.algorithm);
+	if (digestLength == 0)
+		throw std::runtime_error("Shard: " + shards.front().path + " is made with unknown algorithm: " + job.algorithm);
+
+	std::uint64_t nextBlock = 0;
+	for (const Shard & shard : shards)
+	{
+		const ShardHeader & header = shard.header;
+		if (header.algorithm != job.algorithm || header.blockSize != job.blockSize || header.totalBlocks != job.totalBlocks)
+			throw std::runtime_error("Shard: " + shard.path + " belongs to another job.");
+		// @note Input rewritten between runs of shards may keep its size, so modification time is compared too.
+		if (header.inputSize != job.inputSize || header.inputModificationTime != job.inputModificationTime)
+			throw std::runtime_error("Shard: " + shard.path + " is made of another input than shard: " + shards.front().path);
+		if (header.firstBlock < nextBlock)
+			throw std::runtime_error("Shard: " + shard.path + " overlaps blocks from " + std::to_string(header.firstBlock) + " to " + std::to_string(nextBlock) + ".");
+		if (header.firstBlock > nextBlock)
+			throw std::runtime_error("Blocks from " + std::to_string(nextBlock) + " to " + std::to_string(header.firstBlock) + " are not covered by shards.");
+
+		// @note Interrupted run may leave any number of whole digests, so only exact size proves shard is complete.
+		if (shard.payloadSize != header.blockCount * digestLength)
+			throw std::runtime_error("Shard: " + shard.path + " is incomplete, it has " + std::to_string(shard.payloadSize) + " bytes of digests instead of "
+									 + std::to_string(header.blockCount * digestLength) + ".");
+		const Checkpoint checkpoint(shard.path);
+		if (boost::filesystem::exists(checkpoint.Path()))
+			throw std::runtime_error("Shard: " + shard.path + " is not finished, its checkpoint: " + checkpoint.Path() + " exists.");
+		nextBlock = header.firstBlock + header.blockCount;
+	}
+	if (nextBlock != job.totalBlocks)
+		throw std::runtime_error("Blocks from " + std::to_string(nextBlock) + " to " + std::to_string(job.totalBlocks) + " are not covered by shards.");
+
+	std::ofstream output(outputFile, std::ios_base::binary | std::ios_base::trunc);
+	if (!output.is_open())
+		throw std::runtime_error("Cannot open file: " + outputFile);
+
+	for (const Shard & shard : shards)
+	{
+		if (shard.payloadSize == 0)
+			continue;
+		std::ifstream input(shard.path, std::ios_base::binary);
+		input.seekg(static_cast<std::streamoff>(shard.payloadOffset));
+		output << input.rdbuf();
+	}
+
+	output.flush();
+	if (!output)
+		throw std::runtime_error("Cannot write file: " + outputFile);
+}
+
+} // namespace Calculator
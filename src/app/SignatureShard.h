@@ -0,0 +1,42 @@
+#ifndef SIGNATURE_SHARD_H
+#define SIGNATURE_SHARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Calculator
+{
+
+/// @brief Describes part of the signature computed for a range of blocks.
+/// Shard file is a header line followed by hashes of blocks [firstBlock, firstBlock + blockCount).
+struct ShardHeader
+{
+	std::string algorithm;
+	std::uint64_t blockSize {0};
+	std::uint64_t firstBlock {0};
+	std::uint64_t blockCount {0};
+	/// @brief Number of blocks in the whole input, used to check that merged shards cover all of it.
+	std::uint64_t totalBlocks {0};
+	/// @brief Size and modification time (nanoseconds since epoch) of the input, shards of another input are not merged.
+	std::uint64_t inputSize {0};
+	std::int64_t inputModificationTime {0};
+};
+
+/// @brief Returns length of hex digest made by algorithm (md5 or crc), 0 for unknown algorithm.
+size_t DigestLength(const std::string & algorithm);
+
+/// @brief Returns header line including trailing new line.
+std::string FormatShardHeader(const ShardHeader & header);
+/// @note Throws exception if line is not a shard header.
+ShardHeader ParseShardHeader(const std::string & line);
+
+/// @brief Stitches shards into signature identical to the one computed by single run over the whole input.
+/// @note Throws exception if shards were made with different parameters or of different inputs, overlap, leave gaps, are incomplete or
+/// still have checkpoint of interrupted run.
+void MergeShards(const std::vector<std::string> & shardFiles, const std::string & outputFile);
+
+} // namespace Calculator
+
+#endif
@@ -1,19 +1,34 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <optional>
 #include <string>
+#include <system_error>
 #include <iostream>
+#include <vector>
 
+#include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include "AutoTuner.h"
+#include "Checkpoint.h"
+#include "DataProviderFactory.h"
 #include "SignatureCalculator.h"
+#include "SignatureDaemon.h"
+#include "SignatureShard.h"
 
-#include "FileHashSaver.h"
-#include "IFStreamDataProvider.h"
+#include "IDataProvider.h"
+#include "SignatureDedup.h"
+#include "SignatureIndex.h"
+#include "SignatureReader.h"
 #include "MD5HashCalculator.h"
 #include "CRCHashCalculator.h"
 
-#if !defined(_WIN32) && !defined(_WIN64)
-	#include "MMapDataProvider.h"
-#endif
-
 namespace detail
 {
 
@@ -40,6 +55,32 @@ const KeyInfo INPUT_FILE_KEY("input_file", "i");
 const KeyInfo OUTPUT_FILE_KEY("output_file", "o");
 const KeyInfo BLOCK_SIZE_KEY("block_size", "b");
 const KeyInfo ALGORITM_TYPE("algorithm", "a");
+const KeyInfo THREADS_KEY("threads", "t");
+const KeyInfo PROVIDER_KEY("provider", "p");
+const KeyInfo AUTO_TUNE_KEY("auto_tune");
+const KeyInfo TUNE_PROFILE_KEY("tune_profile");
+const KeyInfo NUMA_KEY("numa");
+const KeyInfo CACHE_POLICY_KEY("cache_policy");
+const KeyInfo RESUME_KEY("resume");
+const KeyInfo CHECKPOINT_INTERVAL_KEY("checkpoint_interval");
+const KeyInfo MEMORY_LIMIT_KEY("memory_limit");
+const KeyInfo POSITIONAL_OUTPUT_KEY("positional_output");
+const KeyInfo OFFSET_KEY("offset");
+const KeyInfo LENGTH_KEY("length");
+const KeyInfo SHARDS_KEY("shards");
+const KeyInfo SOCKET_KEY("socket");
+const KeyInfo CONNECT_KEY("connect");
+const KeyInfo SIGNATURES_KEY("signatures");
+const KeyInfo SPILL_DIRECTORY_KEY("spill_directory");
+const KeyInfo SIGNATURE_KEY("signature");
+const KeyInfo DIGEST_KEY("digest");
+const KeyInfo BUILD_INDEX_KEY("build_index");
+const std::string MERGE_COMMAND = "merge";
+const std::string DAEMON_COMMAND = "daemon";
+const std::string DEDUP_COMMAND = "dedup";
+const std::string QUERY_COMMAND = "query";
+/// @note Routes jobs of existing scripts to the daemon without changing their command lines.
+const char * const SOCKET_ENVIRONMENT_VARIABLE = "SIGNATURE_GENERATOR_SOCKET";
 const KeyInfo HELP_KEY("help", "h");
 
 struct InputParameters
@@ -55,6 +96,20 @@ struct InputParameters
 	std::string outputFile;
 	HashAlgorithm algoritm {HashAlgorithm::md5};
 	size_t blockSize {1048576};
+
+	unsigned int threads {0};
+	std::string provider;
+	bool autoTune {false};
+	std::string tuneProfile {Calculator::AutoTuner::DefaultProfilePath()};
+	bool numaAware {false};
+	std::string cachePolicy;
+	bool resume {false};
+	unsigned int checkpointInterval {30};
+	std::string memoryLimit;
+	bool positionalOutput {false};
+	std::string offset;
+	std::string length;
+	std::string connect;
 };
 
 InputParameters ParseStartOptions(int argc, char** argv)
@@ -65,6 +120,19 @@ InputParameters ParseStartOptions(int argc, char** argv)
 			(OUTPUT_FILE_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "set path for output file")
 			(BLOCK_SIZE_KEY.cluedKey.data(),  boost::program_options::value<size_t>(), "block size")
 			(ALGORITM_TYPE.cluedKey.data(),   boost::program_options::value<std::string>(), "use algoritm (md5 or crc)")
+			(THREADS_KEY.cluedKey.data(),     boost::program_options::value<unsigned int>(), "number of hash workers (default: number of cores)")
+			(PROVIDER_KEY.cluedKey.data(),    boost::program_options::value<std::string>(), "file reading method (mmap, ifstream or pread)")
+			(AUTO_TUNE_KEY.cluedKey.data(),   "choose threads, read window and provider by measuring host")
+			(TUNE_PROFILE_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "file with cached host measurements for auto tune")
+			(NUMA_KEY.cluedKey.data(),        "pin readers and workers to NUMA nodes, keep buffers node local")
+			(CACHE_POLICY_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "page cache usage: keep, drop (evict read data) or bypass (direct I/O)")
+			(RESUME_KEY.cluedKey.data(),      "continue interrupted job from its checkpoint")
+			(CHECKPOINT_INTERVAL_KEY.cluedKey.data(), boost::program_options::value<unsigned int>(), "seconds between checkpoints (default: 30, 0 disables)")
+			(MEMORY_LIMIT_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "memory for data blocks in bytes, K, M and G suffixes are allowed")
+			(POSITIONAL_OUTPUT_KEY.cluedKey.data(), "hash workers write digests straight to their places in output file")
+			(OFFSET_KEY.cluedKey.data(),      boost::program_options::value<std::string>(), "hash only shard starting at this byte, multiple of block size")
+			(LENGTH_KEY.cluedKey.data(),      boost::program_options::value<std::string>(), "hash only shard of this many bytes, multiple of block size")
+			(CONNECT_KEY.cluedKey.data(),     boost::program_options::value<std::string>(), "run job by daemon listening on this socket, output \"-\" prints signature")
 			(HELP_KEY.cluedKey.data(), "show current help message")
 	;
 
@@ -93,6 +161,41 @@ InputParameters ParseStartOptions(int argc, char** argv)
 		parameters.algoritm = variablesMap[ALGORITM_TYPE.key].as<std::string>() == "md5" ? InputParameters::HashAlgorithm::md5
 																						 : InputParameters::HashAlgorithm::crc;
 
+	if (variablesMap.count(THREADS_KEY.key))
+		parameters.threads = variablesMap[THREADS_KEY.key].as<unsigned int>();
+
+	if (variablesMap.count(PROVIDER_KEY.key))
+		parameters.provider = variablesMap[PROVIDER_KEY.key].as<std::string>();
+
+	parameters.autoTune = variablesMap.count(AUTO_TUNE_KEY.key);
+
+	if (variablesMap.count(TUNE_PROFILE_KEY.key))
+		parameters.tuneProfile = variablesMap[TUNE_PROFILE_KEY.key].as<std::string>();
+
+	parameters.numaAware = variablesMap.count(NUMA_KEY.key);
+
+	if (variablesMap.count(CACHE_POLICY_KEY.key))
+		parameters.cachePolicy = variablesMap[CACHE_POLICY_KEY.key].as<std::string>();
+
+	parameters.resume = variablesMap.count(RESUME_KEY.key);
+
+	if (variablesMap.count(CHECKPOINT_INTERVAL_KEY.key))
+		parameters.checkpointInterval = variablesMap[CHECKPOINT_INTERVAL_KEY.key].as<unsigned int>();
+
+	if (variablesMap.count(MEMORY_LIMIT_KEY.key))
+		parameters.memoryLimit = variablesMap[MEMORY_LIMIT_KEY.key].as<std::string>();
+
+	parameters.positionalOutput = variablesMap.count(POSITIONAL_OUTPUT_KEY.key);
+
+	if (variablesMap.count(OFFSET_KEY.key))
+		parameters.offset = variablesMap[OFFSET_KEY.key].as<std::string>();
+
+	if (variablesMap.count(LENGTH_KEY.key))
+		parameters.length = variablesMap[LENGTH_KEY.key].as<std::string>();
+
+	if (variablesMap.count(CONNECT_KEY.key))
+		parameters.connect = variablesMap[CONNECT_KEY.key].as<std::string>();
+
 	return parameters;
 }
 
@@ -104,6 +207,336 @@ void AppendInvalidParameter(std::string & to, const std::string paramName)
 	to += paramName;
 }
 
+/// @brief Parses size with optional binary suffix, e.g. "512M".
+bool ParseSize(const std::string & text, size_t & size)
+{
+	if (text.empty() || !std::isdigit(static_cast<unsigned char>(text.front())))
+		return false;
+
+	size_t parsedLength = 0;
+	unsigned long long value = 0;
+	try
+	{
+		value = std::stoull(text, &parsedLength);
+	}
+	catch (const std::exception &)
+	{
+		return false;
+	}
+
+	const std::string suffix = text.substr(parsedLength);
+	unsigned int shift = 0;
+	if (suffix == "K" || suffix == "k")
+		shift = 10;
+	else if (suffix == "M" || suffix == "m")
+		shift = 20;
+	else if (suffix == "G" || suffix == "g")
+		shift = 30;
+	else if (!suffix.empty())
+		return false;
+
+	if (value > (std::numeric_limits<size_t>::max() >> shift))
+		return false;
+
+	size = static_cast<size_t>(value) << shift;
+	return true;
+}
+
+/// @brief Parses and runs "merge" command, argv starts with the command name.
+int RunMerge(int argc, char** argv)
+{
+	boost::program_options::options_description desription;
+	desription.add_options()
+			(OUTPUT_FILE_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "set path for merged signature")
+			(SHARDS_KEY.cluedKey.data(),      boost::program_options::value<std::vector<std::string>>(), "shard signatures made with offset and length")
+			(HELP_KEY.cluedKey.data(), "show current help message")
+	;
+	boost::program_options::positional_options_description positional;
+	positional.add(SHARDS_KEY.key.data(), -1);
+
+	boost::program_options::variables_map variablesMap;
+	boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(desription).positional(positional).run(), variablesMap);
+	boost::program_options::notify(variablesMap);
+
+	if (variablesMap.count(HELP_KEY.key))
+	{
+		std::cout << "Usage: " << MERGE_COMMAND << " --" << OUTPUT_FILE_KEY.key << " <file> <shard>...\n" << desription << std::endl;
+		return 0;
+	}
+
+	if (!variablesMap.count(OUTPUT_FILE_KEY.key) || !variablesMap.count(SHARDS_KEY.key))
+	{
+		std::string invalid_parameters;
+		if (!variablesMap.count(OUTPUT_FILE_KEY.key))
+			AppendInvalidParameter(invalid_parameters, OUTPUT_FILE_KEY.key);
+		if (!variablesMap.count(SHARDS_KEY.key))
+			AppendInvalidParameter(invalid_parameters, SHARDS_KEY.key);
+
+		std::cerr << "Invalid parameters: " << invalid_parameters << "\nCall " << MERGE_COMMAND << " --help for information." << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		Calculator::MergeShards(variablesMap[SHARDS_KEY.key].as<std::vector<std::string>>(), variablesMap[OUTPUT_FILE_KEY.key].as<std::string>());
+	}
+	catch(const std::exception & ex)
+	{
+		std::cerr << "Caught exception: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+Calculator::SignatureDaemon * runningDaemon = nullptr;
+
+void StopDaemon(int)
+{
+	if (runningDaemon)
+		runningDaemon->Stop();
+}
+
+/// @brief Parses and runs "daemon" command, argv starts with the command name.
+int RunDaemon(int argc, char** argv)
+{
+	boost::program_options::options_description desription;
+	desription.add_options()
+			(SOCKET_KEY.cluedKey.data(),      boost::program_options::value<std::string>(), "path of unix socket to listen on")
+			(THREADS_KEY.cluedKey.data(),     boost::program_options::value<unsigned int>(), "number of hash workers shared by all jobs (default: number of cores)")
+			(HELP_KEY.cluedKey.data(), "show current help message")
+	;
+
+	boost::program_options::variables_map variablesMap;
+	boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desription), variablesMap);
+	boost::program_options::notify(variablesMap);
+
+	if (variablesMap.count(HELP_KEY.key))
+	{
+		std::cout << "Usage: " << DAEMON_COMMAND << " --" << SOCKET_KEY.key << " <path>\n" << desription << std::endl;
+		return 0;
+	}
+
+	if (!variablesMap.count(SOCKET_KEY.key))
+	{
+		std::cerr << "Invalid parameters: " << SOCKET_KEY.key << "\nCall " << DAEMON_COMMAND << " --help for information." << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		const unsigned int threads = variablesMap.count(THREADS_KEY.key) ? variablesMap[THREADS_KEY.key].as<unsigned int>() : 0;
+		Calculator::SignatureDaemon daemon(variablesMap[SOCKET_KEY.key].as<std::string>(), threads);
+		runningDaemon = &daemon;
+		std::signal(SIGINT, StopDaemon);
+		std::signal(SIGTERM, StopDaemon);
+		daemon.Run();
+		runningDaemon = nullptr;
+	}
+	catch(const std::exception & ex)
+	{
+		std::cerr << "Caught exception: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/// @brief Parses and runs "dedup" command, argv starts with the command name.
+int RunDedup(int argc, char** argv)
+{
+	boost::program_options::options_description desription;
+	desription.add_options()
+			(ALGORITM_TYPE.cluedKey.data(),   boost::program_options::value<std::string>(), "algoritm signatures were made with (md5 or crc)")
+			(OUTPUT_FILE_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "set path for report (default: standard output)")
+			(MEMORY_LIMIT_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "memory for digests table in bytes, K, M and G suffixes are allowed (default: 1G)")
+			(SPILL_DIRECTORY_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "directory for partitions of digests which do not fit into memory")
+			(SIGNATURES_KEY.cluedKey.data(),  boost::program_options::value<std::vector<std::string>>(), "signatures or shard signatures")
+			(HELP_KEY.cluedKey.data(), "show current help message")
+	;
+	boost::program_options::positional_options_description positional;
+	positional.add(SIGNATURES_KEY.key.data(), -1);
+
+	boost::program_options::variables_map variablesMap;
+	boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(desription).positional(positional).run(), variablesMap);
+	boost::program_options::notify(variablesMap);
+
+	if (variablesMap.count(HELP_KEY.key))
+	{
+		std::cout << "Usage: " << DEDUP_COMMAND << " [options] <signature>...\n" << desription << std::endl;
+		return 0;
+	}
+
+	const std::string algorithm = variablesMap.count(ALGORITM_TYPE.key) ? variablesMap[ALGORITM_TYPE.key].as<std::string>() : "md5";
+	const bool algorithmValid = algorithm == "md5" || algorithm == "crc";
+	size_t memoryLimit = Dedup::SignatureDedup::DEFAULT_MEMORY_BUDGET;
+	const bool memoryLimitValid = !variablesMap.count(MEMORY_LIMIT_KEY.key) || ParseSize(variablesMap[MEMORY_LIMIT_KEY.key].as<std::string>(), memoryLimit);
+	if (!variablesMap.count(SIGNATURES_KEY.key) || !algorithmValid || !memoryLimitValid)
+	{
+		std::string invalid_parameters;
+		if (!variablesMap.count(SIGNATURES_KEY.key))
+			AppendInvalidParameter(invalid_parameters, SIGNATURES_KEY.key);
+		if (!algorithmValid)
+			AppendInvalidParameter(invalid_parameters, ALGORITM_TYPE.key);
+		if (!memoryLimitValid)
+			AppendInvalidParameter(invalid_parameters, MEMORY_LIMIT_KEY.key);
+
+		std::cerr << "Invalid parameters: " << invalid_parameters << "\nCall " << DEDUP_COMMAND << " --help for information." << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		// @note Signature is made of hex digests: 16 bytes of md5 or 4 bytes of crc.
+		const size_t digestLength = algorithm == "md5" ? 32 : 8;
+		const std::string spillDirectory = variablesMap.count(SPILL_DIRECTORY_KEY.key) ? variablesMap[SPILL_DIRECTORY_KEY.key].as<std::string>() : std::string();
+		Dedup::SignatureDedup dedup(digestLength, memoryLimit, spillDirectory);
+		for (const std::string & signature : variablesMap[SIGNATURES_KEY.key].as<std::vector<std::string>>())
+			dedup.AddSignature(signature);
+
+		std::ofstream outputFile;
+		if (variablesMap.count(OUTPUT_FILE_KEY.key))
+		{
+			outputFile.open(variablesMap[OUTPUT_FILE_KEY.key].as<std::string>(), std::ios_base::trunc);
+			if (!outputFile.is_open())
+				throw std::runtime_error("Cannot open file: " + variablesMap[OUTPUT_FILE_KEY.key].as<std::string>());
+		}
+		std::ostream & output = outputFile.is_open() ? outputFile : std::cout;
+
+		// @note Every duplicate group is one line: digest, number of blocks, signature and index of its first block.
+		const Dedup::DedupReport report = dedup.Run([&output](const Dedup::DuplicateGroup & group)
+		{
+			output << group.digest << ' ' << group.count << ' ' << *group.firstFile << ' ' << group.firstBlock << '\n';
+		});
+		output << "# total_blocks=" << report.totalBlocks << '\n'
+			   << "# unique_blocks=" << report.uniqueBlocks << '\n'
+			   << "# duplicate_groups=" << report.duplicateGroups << '\n'
+			   << "# dedup_ratio=" << report.Ratio() << std::endl;
+		if (!output)
+			throw std::runtime_error("Cannot write report.");
+	}
+	catch(const std::exception & ex)
+	{
+		std::cerr << "Caught exception: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/// @brief Parses and runs "query" command, argv starts with the command name.
+int RunQuery(int argc, char** argv)
+{
+	boost::program_options::options_description desription;
+	desription.add_options()
+			(ALGORITM_TYPE.cluedKey.data(),   boost::program_options::value<std::string>(), "algoritm signature was made with (md5 or crc)")
+			(BLOCK_SIZE_KEY.cluedKey.data(),  boost::program_options::value<size_t>(), "block size signature was made with, shard signatures keep it in header")
+			(OFFSET_KEY.cluedKey.data(),      boost::program_options::value<std::string>(), "print digest of block holding this byte of input")
+			(LENGTH_KEY.cluedKey.data(),      boost::program_options::value<std::string>(), "print digests of all blocks of this many bytes starting at offset")
+			(DIGEST_KEY.cluedKey.data(),      boost::program_options::value<std::string>(), "print indexes of blocks with this digest")
+			(BUILD_INDEX_KEY.cluedKey.data(), "write sorted index next to signature, digest lookups use it instead of scan")
+			(MEMORY_LIMIT_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "memory for sorting index in bytes, K, M and G suffixes are allowed (default: 256M)")
+			(SPILL_DIRECTORY_KEY.cluedKey.data(), boost::program_options::value<std::string>(), "directory for sorted runs of index which do not fit into memory")
+			(SIGNATURE_KEY.cluedKey.data(),   boost::program_options::value<std::string>(), "signature or shard signature")
+			(HELP_KEY.cluedKey.data(), "show current help message")
+	;
+	boost::program_options::positional_options_description positional;
+	positional.add(SIGNATURE_KEY.key.data(), 1);
+
+	boost::program_options::variables_map variablesMap;
+	boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(desription).positional(positional).run(), variablesMap);
+	boost::program_options::notify(variablesMap);
+
+	if (variablesMap.count(HELP_KEY.key))
+	{
+		std::cout << "Usage: " << QUERY_COMMAND << " [options] <signature>\n" << desription << std::endl;
+		return 0;
+	}
+
+	const std::string algorithm = variablesMap.count(ALGORITM_TYPE.key) ? variablesMap[ALGORITM_TYPE.key].as<std::string>() : "md5";
+	const bool algorithmValid = algorithm == "md5" || algorithm == "crc";
+	size_t offset = 0;
+	const bool offsetValid = !variablesMap.count(OFFSET_KEY.key) || ParseSize(variablesMap[OFFSET_KEY.key].as<std::string>(), offset);
+	size_t length = 0;
+	const bool lengthValid = !variablesMap.count(LENGTH_KEY.key)
+		|| (variablesMap.count(OFFSET_KEY.key) && ParseSize(variablesMap[LENGTH_KEY.key].as<std::string>(), length) && length > 0);
+	size_t memoryLimit = Reader::SignatureIndex::DEFAULT_MEMORY_BUDGET;
+	const bool memoryLimitValid = !variablesMap.count(MEMORY_LIMIT_KEY.key) || ParseSize(variablesMap[MEMORY_LIMIT_KEY.key].as<std::string>(), memoryLimit);
+	const bool queryRequested = variablesMap.count(OFFSET_KEY.key) || variablesMap.count(DIGEST_KEY.key) || variablesMap.count(BUILD_INDEX_KEY.key);
+	if (!variablesMap.count(SIGNATURE_KEY.key) || !algorithmValid || !offsetValid || !lengthValid || !memoryLimitValid || !queryRequested)
+	{
+		std::string invalid_parameters;
+		if (!variablesMap.count(SIGNATURE_KEY.key))
+			AppendInvalidParameter(invalid_parameters, SIGNATURE_KEY.key);
+		if (!algorithmValid)
+			AppendInvalidParameter(invalid_parameters, ALGORITM_TYPE.key);
+		if (!offsetValid || !queryRequested)
+			AppendInvalidParameter(invalid_parameters, OFFSET_KEY.key);
+		if (!lengthValid)
+			AppendInvalidParameter(invalid_parameters, LENGTH_KEY.key);
+		if (!memoryLimitValid)
+			AppendInvalidParameter(invalid_parameters, MEMORY_LIMIT_KEY.key);
+		if (!queryRequested)
+		{
+			AppendInvalidParameter(invalid_parameters, DIGEST_KEY.key);
+			AppendInvalidParameter(invalid_parameters, BUILD_INDEX_KEY.key);
+		}
+
+		std::cerr << "Invalid parameters: " << invalid_parameters << "\nCall " << QUERY_COMMAND << " --help for information." << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		const size_t digestLength = algorithm == "md5" ? 32 : 8;
+		const std::string signaturePath = variablesMap[SIGNATURE_KEY.key].as<std::string>();
+		const std::uint64_t blockSize = variablesMap.count(BLOCK_SIZE_KEY.key) ? variablesMap[BLOCK_SIZE_KEY.key].as<size_t>() : 0;
+		std::optional<Reader::SignatureReader> reader(std::in_place, signaturePath, digestLength, blockSize);
+
+		if (variablesMap.count(BUILD_INDEX_KEY.key))
+		{
+			const std::string spillDirectory = variablesMap.count(SPILL_DIRECTORY_KEY.key) ? variablesMap[SPILL_DIRECTORY_KEY.key].as<std::string>() : std::string();
+			Reader::SignatureIndex::Build(*reader, Reader::SignatureReader::IndexPath(signaturePath), memoryLimit, spillDirectory);
+			reader.emplace(signaturePath, digestLength, blockSize);
+		}
+
+		// @note Every block is one line: its index and digest.
+		if (variablesMap.count(OFFSET_KEY.key))
+		{
+			const std::uint64_t firstBlock = reader->BlockAt(offset);
+			if (length == 0)
+				std::cout << firstBlock << ' ' << reader->Digest(firstBlock) << '\n';
+			else
+				reader->ForEachDigest(firstBlock, reader->BlockAt(offset + length - 1) + 1, [](std::uint64_t block, std::string_view digest)
+				{
+					std::cout << block << ' ' << digest << '\n';
+				});
+		}
+
+		if (variablesMap.count(DIGEST_KEY.key))
+			for (const std::uint64_t block : reader->Find(variablesMap[DIGEST_KEY.key].as<std::string>()))
+				std::cout << block << '\n';
+
+		if (!std::cout.flush())
+			throw std::runtime_error("Cannot write query result.");
+	}
+	catch(const std::exception & ex)
+	{
+		std::cerr << "Caught exception: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/// @brief Daemon runs jobs with its own defaults, parameters of reading and durability are not passed to it.
+bool DaemonCompatible(const InputParameters & params)
+{
+	return params.threads == 0 && params.provider.empty() && !params.autoTune && !params.numaAware
+		&& params.cachePolicy.empty() && !params.resume && params.memoryLimit.empty() && !params.positionalOutput
+		&& params.offset.empty() && params.length.empty();
+}
+
 bool BlockSizeValid(size_t blockSize)
 {
 #if __x86_64__ || __arm64__ || __ppc64__ || _WIN64
@@ -117,12 +550,34 @@ bool BlockSizeValid(size_t blockSize)
 
 int main(int argc, char** argv)
 {
+	if (argc > 1 && argv[1] == detail::MERGE_COMMAND)
+		return detail::RunMerge(argc - 1, argv + 1);
+	if (argc > 1 && argv[1] == detail::DAEMON_COMMAND)
+		return detail::RunDaemon(argc - 1, argv + 1);
+	if (argc > 1 && argv[1] == detail::DEDUP_COMMAND)
+		return detail::RunDedup(argc - 1, argv + 1);
+	if (argc > 1 && argv[1] == detail::QUERY_COMMAND)
+		return detail::RunQuery(argc - 1, argv + 1);
+
 	const detail::InputParameters params = detail::ParseStartOptions(argc, argv);
 
 	if (params.helpRequested)
 		return 0;
 
-	if (params.inputFile.empty() || params.outputFile.empty() || params.blockSize < 1)
+	Calculator::ProviderType providerType = Calculator::AvailableProviderTypes().front();
+	const bool providerValid = params.provider.empty() || Calculator::FromString(params.provider, providerType);
+	CachePolicy cachePolicy = CachePolicy::keep;
+	const bool cachePolicyValid = params.cachePolicy.empty() || Calculator::FromString(params.cachePolicy, cachePolicy);
+	size_t memoryLimit = 0;
+	const bool memoryLimitValid = params.memoryLimit.empty() || (detail::ParseSize(params.memoryLimit, memoryLimit) && memoryLimit >= params.blockSize);
+	// @note Shard borders must be borders of blocks, otherwise merged shards differ from the whole file signature.
+	size_t offset = 0;
+	const bool offsetValid = params.offset.empty() || (detail::ParseSize(params.offset, offset) && params.blockSize > 0 && offset % params.blockSize == 0);
+	size_t length = 0;
+	const bool lengthValid = params.length.empty() || (detail::ParseSize(params.length, length) && params.blockSize > 0 && length > 0 && length % params.blockSize == 0);
+	const bool sharded = !params.offset.empty() || !params.length.empty();
+
+	if (params.inputFile.empty() || params.outputFile.empty() || params.blockSize < 1 || !providerValid || !cachePolicyValid || !memoryLimitValid || !offsetValid || !lengthValid)
 	{
 		std::string invalid_parameters;
 		if (params.inputFile.empty())
@@ -131,30 +586,144 @@ int main(int argc, char** argv)
 			detail::AppendInvalidParameter(invalid_parameters, detail::OUTPUT_FILE_KEY.key);
 		if (params.blockSize < 1 || detail::BlockSizeValid(params.blockSize))
 			detail::AppendInvalidParameter(invalid_parameters, detail::BLOCK_SIZE_KEY.key);
+		if (!providerValid)
+			detail::AppendInvalidParameter(invalid_parameters, detail::PROVIDER_KEY.key);
+		if (!cachePolicyValid)
+			detail::AppendInvalidParameter(invalid_parameters, detail::CACHE_POLICY_KEY.key);
+		if (!memoryLimitValid)
+			detail::AppendInvalidParameter(invalid_parameters, detail::MEMORY_LIMIT_KEY.key);
+		if (!offsetValid)
+			detail::AppendInvalidParameter(invalid_parameters, detail::OFFSET_KEY.key);
+		if (!lengthValid)
+			detail::AppendInvalidParameter(invalid_parameters, detail::LENGTH_KEY.key);
 
 		std::cerr << "Invalid parameters: " << invalid_parameters << "\nCall " << argv[0] << " --help for information." << std::endl;
 		return 1;
 	}
 
+	const bool inlineOutput = params.outputFile == Calculator::SignatureJob::INLINE_OUTPUT;
+	const char * socketVariable = std::getenv(detail::SOCKET_ENVIRONMENT_VARIABLE);
+	const std::string socketPath = !params.connect.empty() ? params.connect : (socketVariable ? socketVariable : "");
+	if (!socketPath.empty())
+	{
+		// @note Explicitly requested daemon must run the job, the one from environment is used only when it can.
+		const bool daemonRequired = !params.connect.empty() || inlineOutput;
+		if (!detail::DaemonCompatible(params) || Calculator::IsStreamInput(params.inputFile))
+		{
+			if (daemonRequired)
+			{
+				std::cerr << "Job parameters are not supported by daemon, run it without " << detail::CONNECT_KEY.key << "." << std::endl;
+				return 1;
+			}
+		}
+		else
+		{
+			try
+			{
+				Calculator::SignatureJob job;
+				// @note Daemon has its own working directory.
+				job.inputFile = boost::filesystem::absolute(params.inputFile).string();
+				job.outputFile = inlineOutput ? params.outputFile : boost::filesystem::absolute(params.outputFile).string();
+				job.blockSize = params.blockSize;
+				job.algorithm = params.algoritm == detail::InputParameters::HashAlgorithm::md5 ? "md5" : "crc";
+				if (const std::optional<std::string> signature = Calculator::RunByDaemon(socketPath, job, daemonRequired))
+				{
+					std::cout << *signature << std::flush;
+					return 0;
+				}
+			}
+			catch(const std::exception & ex)
+			{
+				std::cerr << "Caught exception: " << ex.what() << std::endl;
+				return 1;
+			}
+		}
+	}
+
 	try
 	{
-		std::shared_ptr<IHashSaver> hashSaver(std::make_shared<FileHashSaver>(params.outputFile));
+		if (inlineOutput)
+			throw std::invalid_argument("Signature is printed only by daemon, use " + detail::CONNECT_KEY.key + " or output file.");
+
 		std::shared_ptr<Hash::IHashCalculator> hash_calculator;
 		if (params.algoritm == detail::InputParameters::HashAlgorithm::md5)
 			hash_calculator = std::make_shared<Hash::MD5Hash>();
 		else if (params.algoritm == detail::InputParameters::HashAlgorithm::crc)
 			hash_calculator = std::make_shared<Hash::CRCHash>();
-
-		std::shared_ptr<IDataProvider> dataProvider;
-
-#if !defined(_WIN32) && !defined(_WIN64)
-		dataProvider = std::make_shared<MMapDataProvider>(params.inputFile);
-#endif
-		if (!dataProvider)
-			dataProvider = std::make_shared<IFStreamDataProvider>(params.inputFile);
-
-		Calculator::CalculatorManager c(dataProvider, hashSaver, hash_calculator, params.blockSize);
+		const std::string algorithmName = params.algoritm == detail::InputParameters::HashAlgorithm::md5 ? "md5" : "crc";
+
+		// @note Stream cannot be read again, so there is nothing to resume or to calibrate on.
+		const bool streamInput = Calculator::IsStreamInput(params.inputFile);
+		if (streamInput && params.resume)
+			throw std::invalid_argument("Stream input: " + params.inputFile + " cannot be resumed.");
+		if (streamInput && sharded)
+			throw std::invalid_argument("Stream input: " + params.inputFile + " cannot be split into shards.");
+
+		Calculator::ShardHeader shard;
+		if (sharded)
+		{
+			const std::uint64_t inputSize = boost::filesystem::file_size(params.inputFile);
+			shard.algorithm = algorithmName;
+			shard.blockSize = params.blockSize;
+			shard.totalBlocks = (inputSize + params.blockSize - 1) / params.blockSize;
+			shard.firstBlock = offset / params.blockSize;
+			if (shard.firstBlock > shard.totalBlocks)
+				throw std::invalid_argument("Offset: " + params.offset + " is beyond the end of input file.");
+			// @note Last shard may be given any length which reaches the end of file.
+			const std::uint64_t endBlock = length > 0 ? std::min<std::uint64_t>(shard.firstBlock + length / params.blockSize, shard.totalBlocks)
+													  : shard.totalBlocks;
+			shard.blockCount = endBlock - shard.firstBlock;
+		}
+
+		const Calculator::Checkpoint checkpoint(params.outputFile);
+		Calculator::CheckpointState jobState = streamInput ? Calculator::CheckpointState()
+														   : Calculator::Checkpoint::Describe(params.inputFile, params.blockSize, algorithmName);
+		if (sharded)
+		{
+			jobState.shardFirstBlock = shard.firstBlock;
+			jobState.shardEndBlock = shard.firstBlock + shard.blockCount;
+			shard.inputSize = jobState.inputSize;
+			shard.inputModificationTime = jobState.inputModificationTime;
+		}
+		const Calculator::CheckpointedOutput output = Calculator::OpenCheckpointedOutput(checkpoint, jobState, params.resume, params.outputFile,
+																						sharded ? Calculator::FormatShardHeader(shard) : std::string(),
+																						params.positionalOutput ? Calculator::DigestLength(algorithmName) : 0,
+																						std::chrono::seconds(params.checkpointInterval));
+		if (params.resume && !output.resumed)
+			std::cerr << "No checkpoint: " << checkpoint.Path() << "; starting from the beginning." << std::endl;
+		const std::shared_ptr<IHashSaver> hashSaver = output.hashSaver;
+
+		Calculator::CalculatorSettings settings;
+		if (params.autoTune && !streamInput)
+		{
+			Calculator::AutoTuner tuner(params.tuneProfile);
+			const Calculator::TuningResult tuning = tuner.Tune(params.inputFile, algorithmName, *hash_calculator, params.blockSize, cachePolicy);
+			settings = tuning.settings;
+			// @note Explicitly passed parameters always win over measured ones.
+			if (params.provider.empty())
+				providerType = tuning.provider;
+		}
+		if (params.threads > 0)
+			settings.threads = params.threads;
+		settings.numaAware = params.numaAware;
+		settings.firstBlock = output.firstBlock;
+		if (sharded)
+			settings.endBlock = shard.firstBlock + shard.blockCount;
+		settings.memoryLimit = memoryLimit;
+
+		if (params.checkpointInterval > 0 && !streamInput)
+			settings.onCommitted = output.onCommitted;
+
+		const Calculator::DataProviderFactory dataProviderFactory = [&params, providerType, cachePolicy]()
+		{
+			return Calculator::CreateDataProvider(providerType, params.inputFile, cachePolicy);
+		};
+
+		Calculator::CalculatorManager c(dataProviderFactory, hashSaver, hash_calculator, params.blockSize, settings);
 		c.Start();
+
+		hashSaver->Sync();
+		checkpoint.Remove();
 	}
 	catch(const std::exception & ex)
 	{
@@ -0,0 +1,64 @@
+# @note Tests of the application parts, every suite is built with the sources it tests.
+add_executable(shard_test_suite "${CMAKE_CURRENT_LIST_DIR}/shard_test.cpp"
+								"${SRC_DIR}/app/Checkpoint.cpp"
+								"${SRC_DIR}/app/SignatureShard.cpp")
+
+target_include_directories(shard_test_suite PRIVATE "${SRC_DIR}/app")
+
+target_compile_definitions(shard_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=shard_test_suite)
+
+target_link_libraries(shard_test_suite Boost::unit_test_framework
+									   Boost::filesystem
+									   TestHelpers
+									   FileHashSaver
+									   SignatureEngine)
+
+add_test(NAME shard_test_runner COMMAND shard_test_suite)
+
+add_executable(checkpoint_test_suite "${CMAKE_CURRENT_LIST_DIR}/checkpoint_test.cpp"
+									 "${SRC_DIR}/app/Checkpoint.cpp"
+									 "${SRC_DIR}/app/SignatureShard.cpp")
+
+target_include_directories(checkpoint_test_suite PRIVATE "${SRC_DIR}/app")
+
+target_compile_definitions(checkpoint_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=checkpoint_test_suite)
+
+target_link_libraries(checkpoint_test_suite Boost::unit_test_framework
+											Boost::filesystem
+											TestHelpers
+											FileHashSaver
+											SignatureEngine)
+
+add_test(NAME checkpoint_test_runner COMMAND checkpoint_test_suite)
+
+add_executable(autotuner_test_suite "${CMAKE_CURRENT_LIST_DIR}/autotuner_test.cpp"
+									"${SRC_DIR}/app/AutoTuner.cpp")
+
+target_include_directories(autotuner_test_suite PRIVATE "${SRC_DIR}/app")
+
+target_compile_definitions(autotuner_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=autotuner_test_suite)
+
+target_link_libraries(autotuner_test_suite Boost::unit_test_framework
+										   Boost::filesystem
+										   TestHelpers
+										   SignatureEngine)
+
+add_test(NAME autotuner_test_runner COMMAND autotuner_test_suite)
+
+# @note Daemon uses unix domain sockets which are not supported on Windows.
+if (NOT WIN32)
+	add_executable(daemon_test_suite "${CMAKE_CURRENT_LIST_DIR}/daemon_test.cpp"
+									 "${SRC_DIR}/app/SignatureDaemon.cpp")
+
+	target_include_directories(daemon_test_suite PRIVATE "${SRC_DIR}/app")
+
+	target_compile_definitions(daemon_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=daemon_test_suite)
+
+	target_link_libraries(daemon_test_suite Boost::unit_test_framework
+											Boost::filesystem
+											TestHelpers
+											FileHashSaver
+											SignatureEngine)
+
+	add_test(NAME daemon_test_runner COMMAND daemon_test_suite)
+endif()
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "AutoTuner.h"
+#include "IHashCalculator.h"
+#include "SignatureEngine.h"
+
+#include "TestFiles.h"
+
+namespace
+{
+using TestHelpers::TemporaryDirectory;
+
+constexpr size_t MEGABYTE = 1048576;
+constexpr size_t BLOCK_SIZE = 65536;
+
+/// @brief Counts hashed blocks, so calibration of hash speed is visible.
+class CountingHashCalculator : public Hash::IHashCalculator
+{
+public:
+	std::string CalculateHash(const std::vector<std::uint8_t> & data) override
+	{
+		return CalculateHash(data.data(), data.size());
+	}
+	std::string CalculateHash(const std::uint8_t * data, size_t size) override
+	{
+		++m_calls;
+		return m_hashCalculator->CalculateHash(data, size);
+	}
+
+	size_t Calls() const { return m_calls; }
+
+private:
+	const std::shared_ptr<Hash::IHashCalculator> m_hashCalculator {Calculator::CreateHashCalculator("md5")};
+	std::atomic<size_t> m_calls {0};
+};
+
+/// @brief Input big enough for calibration of reading.
+std::string MakeInput(const TemporaryDirectory & directory)
+{
+	const std::string path = directory.File("input");
+	std::ofstream(path, std::ios_base::binary) << std::string(2 * MEGABYTE, 'x');
+	return path;
+}
+
+std::map<std::string, std::string> ReadProfile(const std::string & path)
+{
+	std::map<std::string, std::string> profile;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line))
+		profile[line.substr(0, line.find('='))] = line.substr(line.find('=') + 1);
+	return profile;
+}
+
+void WriteProfile(const std::string & path, const std::map<std::string, std::string> & profile)
+{
+	std::ofstream file(path, std::ios_base::trunc);
+	for (const auto & [key, value] : profile)
+		file << key << '=' << value << '\n';
+}
+
+bool IsHashKey(const std::string & key)
+{
+	return key.compare(0, 5, "hash.") == 0;
+}
+
+unsigned int HardwareThreads()
+{
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(workers_follow_ratio_of_speeds)
+{
+	const double hashSpeed = 100.0 * MEGABYTE;
+
+	// @note Storage delivers 3.5 times more than one worker hashes, so 4 workers are needed.
+	Calculator::CalculatorSettings settings = Calculator::AutoTuner::DeriveSettings(hashSpeed, 3.5 * hashSpeed, MEGABYTE, 16);
+	BOOST_CHECK_EQUAL(settings.threads, 4u);
+	BOOST_CHECK_EQUAL(settings.queueDepth, 4u);
+
+	// @note Faster storage than all cores together is limited by cores.
+	settings = Calculator::AutoTuner::DeriveSettings(hashSpeed, 100 * hashSpeed, MEGABYTE, 16);
+	BOOST_CHECK_EQUAL(settings.threads, 16u);
+	BOOST_CHECK_EQUAL(settings.queueDepth, 1u);
+
+	// @note Slow storage is served by one worker.
+	settings = Calculator::AutoTuner::DeriveSettings(hashSpeed, hashSpeed / 10, MEGABYTE, 16);
+	BOOST_CHECK_EQUAL(settings.threads, 1u);
+	BOOST_CHECK_EQUAL(settings.queueDepth, 16u);
+
+	// @note Without measurements every core gets a worker.
+	settings = Calculator::AutoTuner::DeriveSettings(0, 0, MEGABYTE, 8);
+	BOOST_CHECK_EQUAL(settings.threads, 8u);
+	BOOST_CHECK_EQUAL(settings.queueDepth, 2u);
+	settings = Calculator::AutoTuner::DeriveSettings(hashSpeed, 0, MEGABYTE, 0);
+	BOOST_CHECK_EQUAL(settings.threads, 1u);
+
+	BOOST_CHECK_THROW(Calculator::AutoTuner::DeriveSettings(hashSpeed, hashSpeed, 0, 8), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(read_window_is_limited)
+{
+	// @note 16 MiB window is shared by all workers.
+	BOOST_CHECK_EQUAL(Calculator::AutoTuner::DeriveSettings(1, 2, 256 * 1024, 8).queueDepth, 32u);
+	BOOST_CHECK_EQUAL(Calculator::AutoTuner::DeriveSettings(1, 4, 256 * 1024, 8).queueDepth, 16u);
+	// @note Small blocks would make window of thousands blocks, depth is capped at 64.
+	BOOST_CHECK_EQUAL(Calculator::AutoTuner::DeriveSettings(1, 1, 4096, 8).queueDepth, 64u);
+	BOOST_CHECK_EQUAL(Calculator::AutoTuner::DeriveSettings(1, 1, 16 * MEGABYTE / 65, 8).queueDepth, 64u);
+	// @note Block bigger than the window is still read one at a time.
+	BOOST_CHECK_EQUAL(Calculator::AutoTuner::DeriveSettings(1, 1, 64 * MEGABYTE, 8).queueDepth, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(cached_profile_is_used)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	const std::string profilePath = directory.File("cache/host.profile");
+
+	CountingHashCalculator firstCalculator;
+	const Calculator::TuningResult first = Calculator::AutoTuner(profilePath).Tune(input, "md5", firstCalculator, BLOCK_SIZE);
+	BOOST_CHECK(firstCalculator.Calls() > 0);
+	std::map<std::string, std::string> profile = ReadProfile(profilePath);
+	BOOST_REQUIRE_EQUAL(std::count_if(profile.begin(), profile.end(), [](const auto & entry) { return IsHashKey(entry.first); }), 1);
+	BOOST_REQUIRE(profile.size() > 1);
+
+	// @note The same host, storage, algorithm and block size are not measured again.
+	CountingHashCalculator secondCalculator;
+	const Calculator::TuningResult second = Calculator::AutoTuner(profilePath).Tune(input, "md5", secondCalculator, BLOCK_SIZE);
+	BOOST_CHECK_EQUAL(secondCalculator.Calls(), 0u);
+	BOOST_CHECK(ReadProfile(profilePath) == profile);
+	BOOST_CHECK_EQUAL(second.settings.threads, first.settings.threads);
+	BOOST_CHECK_EQUAL(second.settings.queueDepth, first.settings.queueDepth);
+	BOOST_CHECK(second.provider == first.provider);
+
+	// @note Result is derived from cached speeds, provider with the fastest reads is chosen.
+	const Calculator::ProviderType fastest = Calculator::AvailableProviderTypes().back();
+	for (auto & [key, value] : profile)
+		value = IsHashKey(key) ? "1000000" : key.find("." + Calculator::ToString(fastest) + ".") != std::string::npos ? "3500000" : "2000";
+	WriteProfile(profilePath, profile);
+
+	CountingHashCalculator cachedCalculator;
+	const Calculator::TuningResult cached = Calculator::AutoTuner(profilePath).Tune(input, "md5", cachedCalculator, BLOCK_SIZE);
+	const Calculator::CalculatorSettings expected = Calculator::AutoTuner::DeriveSettings(1000000, 3500000, BLOCK_SIZE, HardwareThreads());
+	BOOST_CHECK_EQUAL(cachedCalculator.Calls(), 0u);
+	BOOST_CHECK_EQUAL(cached.settings.threads, expected.threads);
+	BOOST_CHECK_EQUAL(cached.settings.queueDepth, expected.queueDepth);
+	BOOST_CHECK(cached.provider == fastest);
+
+	// @note Another block size needs its own measurement of hashing.
+	CountingHashCalculator otherCalculator;
+	Calculator::AutoTuner(profilePath).Tune(input, "md5", otherCalculator, 2 * BLOCK_SIZE);
+	BOOST_CHECK(otherCalculator.Calls() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_profile_is_measured_again)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	const std::string profilePath = directory.File("host.profile");
+
+	CountingHashCalculator calibration;
+	Calculator::AutoTuner(profilePath).Tune(input, "md5", calibration, BLOCK_SIZE);
+	const std::map<std::string, std::string> measured = ReadProfile(profilePath);
+
+	for (const std::string corrupt : {"", "garbage", "12abc", "0", "-5", "nan", "inf", "1e999"})
+	{
+		std::map<std::string, std::string> profile = measured;
+		for (auto & [key, value] : profile)
+			value = corrupt;
+		WriteProfile(profilePath, profile);
+
+		CountingHashCalculator hashCalculator;
+		const Calculator::TuningResult result = Calculator::AutoTuner(profilePath).Tune(input, "md5", hashCalculator, BLOCK_SIZE);
+		BOOST_CHECK_MESSAGE(hashCalculator.Calls() > 0, "value: " << corrupt);
+		BOOST_CHECK(result.settings.threads >= 1);
+
+		// @note Every broken value is replaced by new measurement.
+		for (const auto & [key, value] : ReadProfile(profilePath))
+			BOOST_CHECK_MESSAGE(std::stod(value) > 0, key << '=' << value);
+		BOOST_CHECK_EQUAL(ReadProfile(profilePath).size(), measured.size());
+	}
+
+	// @note Garbage without values is skipped.
+	std::ofstream(profilePath, std::ios_base::trunc) << "\x01\x02 not a profile\n";
+	CountingHashCalculator hashCalculator;
+	Calculator::AutoTuner(profilePath).Tune(input, "md5", hashCalculator, BLOCK_SIZE);
+	BOOST_CHECK(hashCalculator.Calls() > 0);
+	BOOST_CHECK_EQUAL(ReadProfile(profilePath).size(), measured.size());
+}
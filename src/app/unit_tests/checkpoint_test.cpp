@@ -0,0 +1,224 @@
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "Checkpoint.h"
+#include "DataProviderFactory.h"
+#include "SignatureCalculator.h"
+#include "SignatureEngine.h"
+#include "SignatureShard.h"
+
+#include "TestFiles.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <fcntl.h>
+	#include <sys/stat.h>
+#endif
+
+namespace
+{
+using TestHelpers::TemporaryDirectory;
+using TestHelpers::ReadFile;
+
+constexpr std::uint64_t BLOCK_SIZE = 1000;
+constexpr std::uint64_t TOTAL_BLOCKS = 3000;
+
+/// @brief Input of TOTAL_BLOCKS blocks, the last one is shorter.
+std::string MakeInput(const TemporaryDirectory & directory)
+{
+	const std::string path = directory.File("input");
+	return TestHelpers::WriteRandomFile(path, TOTAL_BLOCKS * BLOCK_SIZE - 321, 7);
+}
+
+struct Interrupted {};
+
+/// @brief Job of signature_generator with checkpoint after every commit.
+class Job
+{
+public:
+	Job(const std::string & input, const std::string & output, bool positional, std::uint64_t firstBlock, std::uint64_t endBlock)
+		: m_input(input)
+		, m_output(output)
+		, m_positional(positional)
+		, m_checkpoint(output)
+		, m_state(Calculator::Checkpoint::Describe(input, BLOCK_SIZE, "md5"))
+	{
+		if (endBlock > 0)
+		{
+			m_shard.algorithm = "md5";
+			m_shard.blockSize = BLOCK_SIZE;
+			m_shard.firstBlock = firstBlock;
+			m_shard.blockCount = endBlock - firstBlock;
+			m_shard.totalBlocks = TOTAL_BLOCKS;
+			m_shard.inputSize = m_state.inputSize;
+			m_shard.inputModificationTime = m_state.inputModificationTime;
+			m_state.shardFirstBlock = firstBlock;
+			m_state.shardEndBlock = endBlock;
+		}
+	}
+
+	/// @param interruptAfter number of commits after which job stops as killed one, zero runs job to the end.
+	/// @return first block of the run.
+	std::uint64_t Run(bool resume, size_t interruptAfter = 0)
+	{
+		const Calculator::CheckpointedOutput output = Calculator::OpenCheckpointedOutput(m_checkpoint, m_state, resume, m_output,
+																						 m_state.shardEndBlock > 0 ? Calculator::FormatShardHeader(m_shard) : std::string(),
+																						 m_positional ? Calculator::DigestLength("md5") : 0,
+																						 std::chrono::seconds(0));
+		BOOST_CHECK_EQUAL(output.resumed, resume);
+
+		Calculator::CalculatorSettings settings;
+		settings.threads = 2;
+		settings.firstBlock = output.firstBlock;
+		settings.endBlock = m_state.shardEndBlock;
+		settings.onCommitted = [&output, interruptAfter, commits = size_t(0)](size_t nextBlock) mutable
+		{
+			output.onCommitted(nextBlock);
+			if (++commits == interruptAfter)
+				throw Interrupted();
+		};
+		const std::string input = m_input;
+		const Calculator::DataProviderFactory factory = [input]()
+		{
+			return Calculator::CreateDataProvider(Calculator::AvailableProviderTypes().front(), input);
+		};
+
+		Calculator::CalculatorManager manager(factory, output.hashSaver, Calculator::CreateHashCalculator("md5"), BLOCK_SIZE, settings);
+		try
+		{
+			manager.Start();
+		}
+		catch (const Interrupted &)
+		{
+			// @note Output after the checkpoint is left as it is, killed job cannot clean it up.
+			return output.firstBlock;
+		}
+		output.hashSaver->Sync();
+		m_checkpoint.Remove();
+		return output.firstBlock;
+	}
+
+	const Calculator::Checkpoint & Checkpoint() const { return m_checkpoint; }
+
+private:
+	const std::string m_input;
+	const std::string m_output;
+	const bool m_positional;
+	const Calculator::Checkpoint m_checkpoint;
+	Calculator::CheckpointState m_state;
+	Calculator::ShardHeader m_shard;
+};
+
+/// @brief Checks that job interrupted after some commits and resumed gives the same output as job run without interruption.
+void CheckResume(const TemporaryDirectory & directory, bool positional, std::uint64_t firstBlock, std::uint64_t endBlock)
+{
+	const std::string input = directory.File("input");
+	Job(input, directory.File("full"), positional, firstBlock, endBlock).Run(false);
+	BOOST_REQUIRE(!ReadFile(directory.File("full")).empty());
+
+	Job interrupted(input, directory.File("resumed"), positional, firstBlock, endBlock);
+	BOOST_CHECK_EQUAL(interrupted.Run(false, 3), firstBlock);
+	const std::optional<Calculator::CheckpointState> state = interrupted.Checkpoint().Load();
+	BOOST_REQUIRE(state);
+	BOOST_REQUIRE(state->nextBlock > firstBlock);
+	BOOST_REQUIRE(state->nextBlock < (endBlock > 0 ? endBlock : TOTAL_BLOCKS));
+
+	// @note Resumed job may be interrupted again.
+	std::uint64_t resumedBlock = Job(input, directory.File("resumed"), positional, firstBlock, endBlock).Run(true, 2);
+	BOOST_CHECK_EQUAL(resumedBlock, state->nextBlock);
+	resumedBlock = Job(input, directory.File("resumed"), positional, firstBlock, endBlock).Run(true);
+	BOOST_CHECK(resumedBlock > state->nextBlock);
+
+	BOOST_CHECK(!boost::filesystem::exists(interrupted.Checkpoint().Path()));
+	BOOST_CHECK(ReadFile(directory.File("resumed")) == ReadFile(directory.File("full")));
+}
+
+/// @brief Saves checkpoint of the job interrupted in the middle of the input.
+void SaveCheckpoint(const std::string & input, const std::string & output)
+{
+	Calculator::CheckpointState state = Calculator::Checkpoint::Describe(input, BLOCK_SIZE, "md5");
+	state.nextBlock = TOTAL_BLOCKS / 2;
+	state.outputSize = TOTAL_BLOCKS / 2 * Calculator::DigestLength("md5");
+	std::ofstream(output, std::ios_base::binary) << std::string(state.outputSize, '0');
+	Calculator::Checkpoint(output).Save(state);
+}
+
+void CheckRejected(const std::string & input, const std::string & output, std::uint64_t blockSize, const std::string & algorithm)
+{
+	const Calculator::Checkpoint checkpoint(output);
+	const Calculator::CheckpointState state = Calculator::Checkpoint::Describe(input, blockSize, algorithm);
+	BOOST_CHECK_THROW(Calculator::OpenCheckpointedOutput(checkpoint, state, true, output, std::string(), 0, std::chrono::seconds(0)), std::runtime_error);
+	// @note Rejected checkpoint and output are kept for the right job.
+	BOOST_CHECK(boost::filesystem::exists(checkpoint.Path()));
+	BOOST_CHECK_EQUAL(boost::filesystem::file_size(output), TOTAL_BLOCKS / 2 * Calculator::DigestLength("md5"));
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(resumed_output_matches_full_run)
+{
+	const TemporaryDirectory directory;
+	MakeInput(directory);
+	CheckResume(directory, false, 0, 0);
+}
+
+BOOST_AUTO_TEST_CASE(resumed_positional_output_matches_full_run)
+{
+	const TemporaryDirectory directory;
+	MakeInput(directory);
+	CheckResume(directory, true, 0, 0);
+}
+
+BOOST_AUTO_TEST_CASE(resumed_shard_matches_full_run)
+{
+	const TemporaryDirectory directory;
+	MakeInput(directory);
+	CheckResume(directory, false, 500, 2500);
+	CheckResume(directory, true, 500, 2500);
+}
+
+BOOST_AUTO_TEST_CASE(checkpoint_of_another_job_is_rejected)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	const std::string output = directory.File("output");
+	SaveCheckpoint(input, output);
+
+	CheckRejected(input, output, BLOCK_SIZE + 1, "md5");
+	CheckRejected(input, output, BLOCK_SIZE, "crc");
+
+	// @note The same job is accepted.
+	BOOST_CHECK_EQUAL(Calculator::OpenCheckpointedOutput(Calculator::Checkpoint(output), Calculator::Checkpoint::Describe(input, BLOCK_SIZE, "md5"),
+														 true, output, std::string(), 0, std::chrono::seconds(0)).firstBlock, TOTAL_BLOCKS / 2);
+
+	SaveCheckpoint(input, output);
+	std::ofstream(input, std::ios_base::binary | std::ios_base::app) << 'x';
+	CheckRejected(input, output, BLOCK_SIZE, "md5");
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+BOOST_AUTO_TEST_CASE(input_modified_within_the_same_second_is_rejected)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	const std::string output = directory.File("output");
+
+	timespec times[2] {};
+	times[0].tv_nsec = UTIME_OMIT;
+	times[1].tv_sec = 1700000000;
+	times[1].tv_nsec = 100000000;
+	BOOST_REQUIRE(utimensat(AT_FDCWD, input.data(), times, 0) == 0);
+	SaveCheckpoint(input, output);
+
+	// @note Input of the same size rewritten in the same second.
+	times[1].tv_nsec = 900000000;
+	BOOST_REQUIRE(utimensat(AT_FDCWD, input.data(), times, 0) == 0);
+	CheckRejected(input, output, BLOCK_SIZE, "md5");
+}
+#endif
@@ -0,0 +1,329 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "DataProviderFactory.h"
+#include "FileHashSaver.h"
+#include "SignatureCalculator.h"
+#include "SignatureDaemon.h"
+#include "SignatureEngine.h"
+
+#include "TestFiles.h"
+
+namespace
+{
+using TestHelpers::TemporaryDirectory;
+using TestHelpers::ReadFile;
+
+constexpr std::uint64_t BLOCK_SIZE = 4096;
+
+std::string MakeInput(const TemporaryDirectory & directory, const std::string & name, size_t size, unsigned int seed)
+{
+	const std::string path = directory.File(name);
+	return TestHelpers::WriteRandomFile(path, size, seed);
+}
+
+/// @brief Signature of the input calculated the same way as signature_generator without daemon.
+std::string LocalSignature(const TemporaryDirectory & directory, const std::string & input, const std::string & algorithm)
+{
+	const std::string output = directory.File("local-" + algorithm);
+	{
+		const auto saver = std::make_shared<FileHashSaver>(output);
+		Calculator::CalculatorSettings settings;
+		settings.threads = 2;
+		const Calculator::DataProviderFactory factory = [&input]()
+		{
+			return Calculator::CreateDataProvider(Calculator::AvailableProviderTypes().front(), input);
+		};
+		Calculator::CalculatorManager manager(factory, saver, Calculator::CreateHashCalculator(algorithm), BLOCK_SIZE, settings);
+		manager.Start();
+		saver->Sync();
+	}
+	const std::string signature = ReadFile(output);
+	boost::filesystem::remove(output);
+	return signature;
+}
+
+Calculator::SignatureJob Job(const std::string & input, const std::string & output, const std::string & algorithm)
+{
+	Calculator::SignatureJob job;
+	job.inputFile = input;
+	job.outputFile = output;
+	job.blockSize = BLOCK_SIZE;
+	job.algorithm = algorithm;
+	return job;
+}
+
+/// @brief Daemon serving clients on its own thread while it exists.
+class RunningDaemon
+{
+public:
+	RunningDaemon(const std::string & socketPath, unsigned int threads, size_t maxClients = Calculator::SignatureDaemon::DEFAULT_MAX_CLIENTS)
+		: m_daemon(socketPath, threads, maxClients)
+		, m_thread(&Calculator::SignatureDaemon::Run, &m_daemon)
+	{}
+	~RunningDaemon()
+	{
+		m_daemon.Stop();
+		m_thread.join();
+	}
+
+private:
+	Calculator::SignatureDaemon m_daemon;
+	std::thread m_thread;
+};
+
+/// @brief Connection to the daemon which sends only what the test asks for.
+class RawConnection
+{
+public:
+	explicit RawConnection(const std::string & socketPath)
+		: m_socket(socket(AF_UNIX, SOCK_STREAM, 0))
+	{
+		sockaddr_un address {};
+		address.sun_family = AF_UNIX;
+		std::strncpy(address.sun_path, socketPath.data(), sizeof(address.sun_path) - 1);
+		BOOST_REQUIRE(m_socket >= 0);
+		BOOST_REQUIRE(connect(m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+	}
+	~RawConnection()
+	{
+		Close();
+	}
+
+	void Send(const std::string & data)
+	{
+		BOOST_REQUIRE(send(m_socket, data.data(), data.size(), 0) == static_cast<ssize_t>(data.size()));
+	}
+
+	void Close()
+	{
+		if (m_socket >= 0)
+			close(m_socket);
+		m_socket = -1;
+	}
+
+private:
+	int m_socket {-1};
+};
+
+/// @brief Leaves socket file of the path as crashed daemon does.
+void LeaveStaleSocket(const std::string & socketPath)
+{
+	sockaddr_un address {};
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, socketPath.data(), sizeof(address.sun_path) - 1);
+	const int socketDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+	BOOST_REQUIRE(socketDescriptor >= 0);
+	BOOST_REQUIRE(bind(socketDescriptor, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+	close(socketDescriptor);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(request_is_parsed)
+{
+	const Calculator::SignatureJob job = Job("/data/in put", "-", "crc");
+	const Calculator::SignatureJob parsed = Calculator::ParseJobRequest("input_file=/data/in put\noutput_file=-\nblock_size=4096\nalgorithm=crc\n");
+	BOOST_CHECK_EQUAL(parsed.inputFile, job.inputFile);
+	BOOST_CHECK_EQUAL(parsed.outputFile, job.outputFile);
+	BOOST_CHECK_EQUAL(parsed.blockSize, job.blockSize);
+	BOOST_CHECK_EQUAL(parsed.algorithm, job.algorithm);
+
+	// @note Value may contain separator, only the first one splits the line.
+	BOOST_CHECK_EQUAL(Calculator::ParseJobRequest("algorithm=md5\nblock_size=1\noutput_file=/a=b\ninput_file=/c\n").outputFile, "/a=b");
+
+	// @note Formatted request ends with empty line which is not passed to parser.
+	const std::string request = Calculator::FormatJobRequest(Job("/in", "/out", "md5"));
+	BOOST_REQUIRE(request.size() > 2 && request.compare(request.size() - 2, 2, "\n\n") == 0);
+	const Calculator::SignatureJob formatted = Calculator::ParseJobRequest(request.substr(0, request.size() - 1));
+	BOOST_CHECK_EQUAL(formatted.inputFile, "/in");
+	BOOST_CHECK_EQUAL(formatted.outputFile, "/out");
+	BOOST_CHECK_EQUAL(formatted.algorithm, "md5");
+
+	BOOST_CHECK_THROW(Calculator::FormatJobRequest(Job("/in\nblock_size=1", "/out", "md5")), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(malformed_request_is_rejected)
+{
+	const std::string fields = "input_file=/in\noutput_file=/out\n";
+	const std::vector<std::string> requests = {
+		"",
+		fields + "block_size=4096\n",
+		fields + "algorithm=md5\n",
+		fields + "block_size=\nalgorithm=md5\n",
+		fields + "block_size=0\nalgorithm=md5\n",
+		fields + "block_size=-1\nalgorithm=md5\n",
+		fields + "block_size=4k\nalgorithm=md5\n",
+		fields + "block_size=99999999999999999999999\nalgorithm=md5\n",
+		fields + "block_size=4096\nalgorithm=sha1\n",
+		fields + "block_size=4096\nalgorithm=md5\ngarbage\n",
+		fields + "block_size=4096\nalgorithm=md5\n=value\n",
+		fields + "block_size=4096\nalgorithm=md5\nalgorithm=crc\n",
+	};
+	for (const std::string & request : requests)
+		BOOST_CHECK_THROW(Calculator::ParseJobRequest(request), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(daemon_output_matches_local_run)
+{
+	const TemporaryDirectory directory;
+	const std::string socketPath = directory.File("socket");
+	// @note Last block is shorter than the others.
+	const std::string input = MakeInput(directory, "input", 100 * BLOCK_SIZE + 17, 1);
+	const RunningDaemon daemon(socketPath, 2);
+
+	for (const std::string algorithm : {"md5", "crc"})
+	{
+		const std::string expected = LocalSignature(directory, input, algorithm);
+		BOOST_REQUIRE(!expected.empty());
+
+		BOOST_CHECK(Calculator::DaemonClient(socketPath).Run(Job(input, Calculator::SignatureJob::INLINE_OUTPUT, algorithm)) == expected);
+
+		const std::string output = directory.File("output-" + algorithm);
+		BOOST_CHECK(Calculator::DaemonClient(socketPath).Run(Job(input, output, algorithm)).empty());
+		BOOST_CHECK(ReadFile(output) == expected);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(failed_job_is_reported)
+{
+	const TemporaryDirectory directory;
+	const std::string socketPath = directory.File("socket");
+	const std::string input = MakeInput(directory, "input", 10 * BLOCK_SIZE, 2);
+	const RunningDaemon daemon(socketPath, 1);
+
+	BOOST_CHECK_THROW(Calculator::DaemonClient(socketPath).Run(Job(directory.File("missing"), "-", "md5")), std::runtime_error);
+	BOOST_CHECK_THROW(Calculator::DaemonClient(socketPath).Run(Job(input, "-", "sha1")), std::runtime_error);
+	BOOST_CHECK_THROW(Calculator::DaemonClient(socketPath).Run(Job("/dev/stdin", "-", "md5")), std::runtime_error);
+
+	// @note Daemon keeps serving after failed jobs.
+	BOOST_CHECK(Calculator::DaemonClient(socketPath).Run(Job(input, "-", "md5")) == LocalSignature(directory, input, "md5"));
+}
+
+BOOST_AUTO_TEST_CASE(clients_share_workers)
+{
+	const TemporaryDirectory directory;
+	const std::string socketPath = directory.File("socket");
+	const std::string firstInput = MakeInput(directory, "first", 2000 * BLOCK_SIZE + 1, 3);
+	const std::string secondInput = MakeInput(directory, "second", 1500 * BLOCK_SIZE, 4);
+	const RunningDaemon daemon(socketPath, 2);
+
+	std::string firstSignature;
+	std::string secondSignature;
+	// @note Both clients connect before any of jobs is completed, so jobs are run by the same workers at the same time.
+	Calculator::DaemonClient firstClient(socketPath);
+	Calculator::DaemonClient secondClient(socketPath);
+	std::thread first([&]() { firstSignature = firstClient.Run(Job(firstInput, "-", "md5")); });
+	std::thread second([&]() { secondSignature = secondClient.Run(Job(secondInput, "-", "crc")); });
+	first.join();
+	second.join();
+
+	BOOST_CHECK(firstSignature == LocalSignature(directory, firstInput, "md5"));
+	BOOST_CHECK(secondSignature == LocalSignature(directory, secondInput, "crc"));
+}
+
+BOOST_AUTO_TEST_CASE(stale_socket_is_replaced)
+{
+	const TemporaryDirectory directory;
+	const std::string socketPath = directory.File("socket");
+	const std::string input = MakeInput(directory, "input", 10 * BLOCK_SIZE, 5);
+
+	LeaveStaleSocket(socketPath);
+	BOOST_REQUIRE(boost::filesystem::exists(socketPath));
+	{
+		const RunningDaemon daemon(socketPath, 1);
+		BOOST_CHECK(Calculator::DaemonClient(socketPath).Run(Job(input, "-", "crc")) == LocalSignature(directory, input, "crc"));
+
+		// @note Socket of running daemon is not taken over.
+		BOOST_CHECK_THROW(Calculator::SignatureDaemon(socketPath, 1), std::runtime_error);
+		BOOST_CHECK(Calculator::DaemonClient(socketPath).Run(Job(input, "-", "crc")) == LocalSignature(directory, input, "crc"));
+	}
+	BOOST_CHECK(!boost::filesystem::exists(socketPath));
+
+	// @note Other files are not removed.
+	std::ofstream(socketPath) << "data";
+	BOOST_CHECK_THROW(Calculator::SignatureDaemon(socketPath, 1), std::runtime_error);
+	BOOST_CHECK_EQUAL(ReadFile(socketPath), "data");
+}
+
+BOOST_AUTO_TEST_CASE(job_is_run_locally_without_daemon)
+{
+	const TemporaryDirectory directory;
+	const std::string socketPath = directory.File("socket");
+	const std::string input = MakeInput(directory, "input", 10 * BLOCK_SIZE, 6);
+	const Calculator::SignatureJob job = Job(input, "-", "md5");
+
+	BOOST_CHECK(!Calculator::RunByDaemon(socketPath, job, false));
+	BOOST_CHECK_THROW(Calculator::RunByDaemon(socketPath, job, true), std::system_error);
+
+	LeaveStaleSocket(socketPath);
+	BOOST_CHECK(!Calculator::RunByDaemon(socketPath, job, false));
+	BOOST_CHECK_THROW(Calculator::RunByDaemon(socketPath, job, true), std::system_error);
+
+	const RunningDaemon daemon(socketPath, 1);
+	const std::optional<std::string> signature = Calculator::RunByDaemon(socketPath, job, false);
+	BOOST_REQUIRE(signature);
+	BOOST_CHECK(*signature == LocalSignature(directory, input, "md5"));
+}
+
+BOOST_AUTO_TEST_CASE(job_of_disconnected_client_is_cancelled)
+{
+	const TemporaryDirectory directory;
+	const std::string socketPath = directory.File("socket");
+	// @note Sparse input is created at once, hashing all of it takes far longer than the test.
+	const std::string input = directory.File("input");
+	std::ofstream(input, std::ios_base::binary).close();
+	boost::filesystem::resize_file(input, std::uint64_t(4) << 30);
+	const std::string output = directory.File("output");
+	const std::string smallInput = MakeInput(directory, "small", 10 * BLOCK_SIZE, 7);
+	// @note Second client is accepted only after the first one is served.
+	const RunningDaemon daemon(socketPath, 1, 1);
+
+	RawConnection gone(socketPath);
+	gone.Send(Calculator::FormatJobRequest(Job(input, output, "md5")));
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	gone.Close();
+
+	BOOST_CHECK(Calculator::DaemonClient(socketPath).Run(Job(smallInput, "-", "crc")) == LocalSignature(directory, smallInput, "crc"));
+	const std::uint64_t fullSize = (std::uint64_t(4) << 30) / BLOCK_SIZE * 32;
+	BOOST_CHECK_MESSAGE(boost::filesystem::file_size(output) < fullSize, "output has " << boost::filesystem::file_size(output) << " bytes");
+}
+
+BOOST_AUTO_TEST_CASE(clients_over_limit_wait)
+{
+	const TemporaryDirectory directory;
+	const std::string socketPath = directory.File("socket");
+	const std::string input = MakeInput(directory, "input", 10 * BLOCK_SIZE, 8);
+	const RunningDaemon daemon(socketPath, 1, 1);
+	BOOST_CHECK_THROW(Calculator::SignatureDaemon(directory.File("other"), 1, 0), std::invalid_argument);
+
+	// @note Client which sends nothing takes the only place.
+	RawConnection idle(socketPath);
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	std::future<std::string> signature = std::async(std::launch::async, [&socketPath, &input]()
+	{
+		return Calculator::DaemonClient(socketPath).Run(Job(input, "-", "md5"));
+	});
+	BOOST_CHECK(signature.wait_for(std::chrono::milliseconds(500)) == std::future_status::timeout);
+
+	idle.Close();
+	BOOST_REQUIRE(signature.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+	BOOST_CHECK(signature.get() == LocalSignature(directory, input, "md5"));
+}
@@ -0,0 +1,171 @@
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "Checkpoint.h"
+#include "DataProviderFactory.h"
+#include "FileHashSaver.h"
+#include "SignatureCalculator.h"
+#include "SignatureEngine.h"
+#include "SignatureShard.h"
+
+#include "TestFiles.h"
+
+namespace
+{
+using TestHelpers::TemporaryDirectory;
+using TestHelpers::ReadFile;
+
+constexpr std::uint64_t BLOCK_SIZE = 1000;
+constexpr std::uint64_t TOTAL_BLOCKS = 48;
+
+/// @brief Input of TOTAL_BLOCKS blocks, the last one is shorter.
+std::string MakeInput(const TemporaryDirectory & directory)
+{
+	const std::string path = directory.File("input");
+	return TestHelpers::WriteRandomFile(path, TOTAL_BLOCKS * BLOCK_SIZE - 123, 3);
+}
+
+/// @brief Hashes blocks [firstBlock, endBlock) of input the same way as signature_generator with --offset and --length.
+void HashBlocks(const std::string & inputFile, const std::string & output, const std::string & algorithm, std::uint64_t firstBlock, std::uint64_t endBlock, bool sharded)
+{
+	const auto saver = std::make_shared<FileHashSaver>(output);
+	if (sharded)
+	{
+		const Calculator::CheckpointState input = Calculator::Checkpoint::Describe(inputFile, BLOCK_SIZE, algorithm);
+		Calculator::ShardHeader header;
+		header.algorithm = algorithm;
+		header.blockSize = BLOCK_SIZE;
+		header.firstBlock = firstBlock;
+		header.blockCount = endBlock - firstBlock;
+		header.totalBlocks = TOTAL_BLOCKS;
+		header.inputSize = input.inputSize;
+		header.inputModificationTime = input.inputModificationTime;
+		saver->Save(Calculator::FormatShardHeader(header));
+	}
+
+	Calculator::CalculatorSettings settings;
+	settings.threads = 2;
+	settings.firstBlock = firstBlock;
+	settings.endBlock = endBlock;
+	const Calculator::DataProviderFactory factory = [&inputFile]()
+	{
+		return Calculator::CreateDataProvider(Calculator::AvailableProviderTypes().front(), inputFile);
+	};
+	Calculator::CalculatorManager manager(factory, saver, Calculator::CreateHashCalculator(algorithm), BLOCK_SIZE, settings);
+	manager.Start();
+	saver->Sync();
+}
+
+void Truncate(const std::string & path, std::uint64_t digests, const std::string & algorithm)
+{
+	const std::string content = ReadFile(path);
+	const size_t headerSize = content.find('\n') + 1;
+	boost::filesystem::resize_file(path, headerSize + digests * Calculator::DigestLength(algorithm));
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(merged_shards_match_full_run)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+
+	for (const std::string algorithm : {"md5", "crc"})
+	{
+		HashBlocks(input, directory.File("full"), algorithm, 0, 0, false);
+		HashBlocks(input, directory.File("shard0"), algorithm, 0, 20, true);
+		HashBlocks(input, directory.File("shard1"), algorithm, 20, 21, true);
+		HashBlocks(input, directory.File("shard2"), algorithm, 21, TOTAL_BLOCKS, true);
+
+		// @note Order of shards on command line does not matter.
+		Calculator::MergeShards({directory.File("shard2"), directory.File("shard0"), directory.File("shard1")}, directory.File("merged"));
+		BOOST_CHECK_EQUAL(ReadFile(directory.File("merged")).size(), TOTAL_BLOCKS * Calculator::DigestLength(algorithm));
+		BOOST_CHECK(ReadFile(directory.File("merged")) == ReadFile(directory.File("full")));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(gap_and_overlap_are_rejected)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	HashBlocks(input, directory.File("shard0"), "md5", 0, 20, true);
+	HashBlocks(input, directory.File("shard1"), "md5", 21, TOTAL_BLOCKS, true);
+	HashBlocks(input, directory.File("overlap"), "md5", 19, TOTAL_BLOCKS, true);
+
+	BOOST_CHECK_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("shard1")}, directory.File("merged")), std::runtime_error);
+	BOOST_CHECK_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("overlap")}, directory.File("merged")), std::runtime_error);
+	BOOST_CHECK_THROW(Calculator::MergeShards({directory.File("shard0")}, directory.File("merged")), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(truncated_shard_is_rejected)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	HashBlocks(input, directory.File("shard0"), "md5", 0, 20, true);
+	HashBlocks(input, directory.File("shard1"), "md5", 20, TOTAL_BLOCKS, true);
+
+	// @note Both shards cut in half still have whole number of digests per block of the same length.
+	Truncate(directory.File("shard0"), 10, "md5");
+	Truncate(directory.File("shard1"), 14, "md5");
+	BOOST_CHECK_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("shard1")}, directory.File("merged")), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(shard_with_checkpoint_is_rejected)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	HashBlocks(input, directory.File("shard0"), "crc", 0, 20, true);
+	HashBlocks(input, directory.File("shard1"), "crc", 20, TOTAL_BLOCKS, true);
+
+	const Calculator::Checkpoint checkpoint(directory.File("shard1"));
+	checkpoint.Save(Calculator::Checkpoint::Describe(input, BLOCK_SIZE, "crc"));
+	BOOST_CHECK_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("shard1")}, directory.File("merged")), std::runtime_error);
+
+	checkpoint.Remove();
+	BOOST_CHECK_NO_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("shard1")}, directory.File("merged")));
+}
+
+BOOST_AUTO_TEST_CASE(shards_of_another_input_are_rejected)
+{
+	const TemporaryDirectory directory;
+	const std::string input = MakeInput(directory);
+	HashBlocks(input, directory.File("shard0"), "md5", 0, 20, true);
+	HashBlocks(input, directory.File("shard1"), "md5", 20, TOTAL_BLOCKS, true);
+	BOOST_REQUIRE_NO_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("shard1")}, directory.File("merged")));
+
+	// @note Input rewritten with the same size between runs of shards has the same number of blocks.
+	const std::time_t modificationTime = boost::filesystem::last_write_time(input);
+	TestHelpers::WriteRandomFile(input, TOTAL_BLOCKS * BLOCK_SIZE - 123, 4);
+	boost::filesystem::last_write_time(input, modificationTime + 10);
+	HashBlocks(input, directory.File("rewritten"), "md5", 20, TOTAL_BLOCKS, true);
+	BOOST_CHECK_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("rewritten")}, directory.File("merged")), std::runtime_error);
+
+	// @note Input of another size with the same number of blocks.
+	TestHelpers::WriteRandomFile(input, TOTAL_BLOCKS * BLOCK_SIZE - 124, 3);
+	HashBlocks(input, directory.File("resized"), "md5", 20, TOTAL_BLOCKS, true);
+	BOOST_CHECK_THROW(Calculator::MergeShards({directory.File("shard0"), directory.File("resized")}, directory.File("merged")), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(header_keeps_input)
+{
+	Calculator::ShardHeader header;
+	header.algorithm = "crc";
+	header.blockSize = BLOCK_SIZE;
+	header.firstBlock = 1;
+	header.blockCount = 2;
+	header.totalBlocks = 3;
+	header.inputSize = 2500;
+	header.inputModificationTime = 1700000000123456789;
+	const std::string line = Calculator::FormatShardHeader(header);
+	const Calculator::ShardHeader parsed = Calculator::ParseShardHeader(line.substr(0, line.size() - 1));
+	BOOST_CHECK_EQUAL(parsed.inputSize, header.inputSize);
+	BOOST_CHECK_EQUAL(parsed.inputModificationTime, header.inputModificationTime);
+
+	// @note Header without input cannot be checked against other shards.
+	BOOST_CHECK_THROW(Calculator::ParseShardHeader("#shard algorithm=md5 block_size=1000 first_block=0 block_count=1 total_blocks=1"), std::invalid_argument);
+}
@@ -14,9 +14,11 @@ public:
 	virtual size_t Read(size_t from, size_t bytes) = 0;
 	/// @brief Return pointer to the begin of read data
 	virtual const std::uint8_t * Data() const = 0;
-	/// @brief Return total size of source.
+	/// @brief Return total size of source or UNKNOWN_SIZE for streams (pipes, stdin).
 	virtual std::size_t TotalSize() const = 0;
 	virtual bool Eof() = 0;
+
+	static constexpr std::size_t UNKNOWN_SIZE = static_cast<std::size_t>(-1);
 };
 
 #endif
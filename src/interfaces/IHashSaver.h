@@ -9,6 +9,9 @@ public:
 	virtual ~IHashSaver() = default;
 
 	virtual void Save(const std::string & hash) = 0;
+	/// @brief Makes everything saved so far durable (e.g. survives power loss).
+	/// @note May throw exception
+	virtual void Sync() = 0;
 };
 
 #endif // IHASH_SERVER_H
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef IPOSITIONAL_DATA_PROVIDER_H
+#define IPOSITIONAL_DATA_PROVIDER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/// @brief Source which may be read into caller buffer.
+/// If reads may be concurrent, data provider is read by hash workers directly, without shared read window.
+/// Otherwise it is read by single reader into recycled buffers of bounded pool.
+class IPositionalDataProvider
+{
+public:
+	virtual ~IPositionalDataProvider() = default;
+
+	/// @brief Reads n bytes from desired position into caller buffer.
+	/// @note Thread safe only if ConcurrentReads() returns true.
+	/// @note May throw exception
+	/// @return size of read data, smaller than requested only at the end of source
+	virtual size_t ReadAt(size_t from, size_t bytes, std::uint8_t * buffer) = 0;
+	/// @brief Return total size of source.
+	virtual std::size_t TotalSize() const = 0;
+	/// @brief Return true if ReadAt may be called by many threads at once.
+	virtual bool ConcurrentReads() const = 0;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef IPOSITIONAL_HASH_SAVER_H
+#define IPOSITIONAL_HASH_SAVER_H
+
+#include <cstdint>
+#include <string>
+
+/// @brief Output of fixed size hashes where every block has known place.
+/// If hash saver supports it, hashes are written by hash workers themselves in any order, without ordered saving.
+class IPositionalHashSaver
+{
+public:
+	virtual ~IPositionalHashSaver() = default;
+
+	/// @brief Writes hash of the block to its place in the output.
+	/// @note Thread safe. May throw exception
+	virtual void SaveAt(std::uint64_t block, const std::string & hash) = 0;
+	/// @brief Prepares output for hashes of all blocks before endBlock, e.g. allocates disk space for them.
+	/// @note May throw exception
+	virtual void Reserve(std::uint64_t endBlock) = 0;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "DirectDataProvider.h"
+
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+namespace
+{
+int OpenDirect(const std::string & filePath)
+{
+#if defined(O_DIRECT)
+	const int fileDescriptor = open(filePath.data(), O_RDONLY | O_DIRECT);
+	if (fileDescriptor < 0 && errno == EINVAL)
+		throw std::runtime_error("File system of " + filePath + " does not support direct I/O.");
+#else
+	const int fileDescriptor = open(filePath.data(), O_RDONLY);
+	#if defined(F_NOCACHE)
+	if (fileDescriptor >= 0)
+		fcntl(fileDescriptor, F_NOCACHE, 1);
+	#endif
+#endif
+	return fileDescriptor;
+}
+} // namespace
+
+void DirectDataProvider::FreeDeleter::operator()(std::uint8_t * data) const
+{
+	free(data);
+}
+
+DirectDataProvider::DirectDataProvider(const std::string & filePath)
+	: m_filePath(filePath)
+	, m_fileDescriptor(OpenDirect(m_filePath))
+	, m_fileSize(boost::filesystem::file_size(m_filePath))
+{
+	if (m_fileDescriptor < 0)
+		throw std::runtime_error("Cannot open file: " + m_filePath + " with error: " + std::to_string(errno));
+}
+
+DirectDataProvider::~DirectDataProvider()
+{
+	close(m_fileDescriptor);
+}
+
+size_t DirectDataProvider::Read(size_t from, size_t bytes)
+{
+	if (from >= m_fileSize)
+	{
+		m_eof = true;
+		return 0;
+	}
+
+	if (bytes > m_fileSize - from)
+		bytes = m_fileSize - from;
+
+	const size_t readFrom = from - from % ALIGNMENT;
+	const size_t readBytes = (from - readFrom + bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+	// @note Buffer only grows, so steady state reading does not allocate.
+	if (m_bufferSize < readBytes)
+	{
+		void * buffer = nullptr;
+		if (posix_memalign(&buffer, ALIGNMENT, readBytes) != 0)
+			throw std::bad_alloc();
+		m_buffer.reset(static_cast<std::uint8_t *>(buffer));
+		m_bufferSize = readBytes;
+	}
+
+	// @note Tail of the file is shorter than aligned size, reading stops at the end of file.
+	size_t done = 0;
+	while (done < readBytes && readFrom + done < m_fileSize)
+	{
+		const ssize_t result = pread(m_fileDescriptor, m_buffer.get() + done, readBytes - done, static_cast<off_t>(readFrom + done));
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			throw std::runtime_error("Cannot read file: " + m_filePath + " with error: " + std::to_string(errno));
+		}
+		if (result == 0)
+			break;
+		done += static_cast<size_t>(result);
+	}
+
+	if (done < from - readFrom + bytes)
+		throw std::runtime_error("Unexpected end of file: " + m_filePath);
+
+	m_dataOffset = from - readFrom;
+	return bytes;
+}
+
+const std::uint8_t * DirectDataProvider::Data() const
+{
+	if (!m_buffer)
+		return nullptr;
+	return m_buffer.get() + m_dataOffset;
+}
+
+std::size_t DirectDataProvider::TotalSize() const
+{
+	return m_fileSize;
+}
+
+bool DirectDataProvider::Eof()
+{
+	return m_eof;
+}
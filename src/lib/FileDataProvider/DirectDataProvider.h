@@ -0,0 +1,40 @@
+#ifndef DIRECT_DATA_PROVIDER_H
+#define DIRECT_DATA_PROVIDER_H
+
+#include <memory>
+#include <string>
+
+#include "IDataProvider.h"
+
+/// @brief Reads file bypassing page cache (O_DIRECT on Linux, F_NOCACHE on macOS).
+/// @note Reads are made at aligned offsets into aligned buffer, so any block size is supported.
+class DirectDataProvider : public IDataProvider
+{
+
+public:
+	DirectDataProvider(const std::string & filePath);
+	~DirectDataProvider();
+
+	size_t Read(size_t from, size_t bytes) override;
+	const std::uint8_t * Data() const override;
+	std::size_t TotalSize() const override;
+	bool Eof() override;
+
+	/// @brief Alignment of file offsets, sizes and memory required for direct I/O.
+	static constexpr size_t ALIGNMENT = 4096;
+
+private:
+	struct FreeDeleter { void operator()(std::uint8_t * data) const; };
+
+	const std::string m_filePath;
+	const int m_fileDescriptor;
+	const size_t m_fileSize;
+	bool m_eof = false;
+
+	std::unique_ptr<std::uint8_t, FreeDeleter> m_buffer;
+	size_t m_bufferSize = 0;
+	/// @note Read starts at aligned offset, requested data starts m_dataOffset bytes later.
+	size_t m_dataOffset = 0;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "FileCacheAdvisor.h"
+
+#include <fcntl.h>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <unistd.h>
+#endif
+
+FileCacheAdvisor::FileCacheAdvisor(int fileDescriptor, CachePolicy policy)
+	: m_policy(policy)
+	, m_fileDescriptor(fileDescriptor)
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+	if (m_policy == CachePolicy::drop && m_fileDescriptor >= 0)
+		posix_fadvise(m_fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+FileCacheAdvisor::FileCacheAdvisor(const std::string & filePath, CachePolicy policy)
+	: FileCacheAdvisor(-1, policy)
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+	if (m_policy != CachePolicy::drop)
+		return;
+
+	m_fileDescriptor = open(filePath.data(), O_RDONLY);
+	m_ownsDescriptor = m_fileDescriptor >= 0;
+	if (m_ownsDescriptor)
+		posix_fadvise(m_fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+	(void)filePath;
+#endif
+}
+
+FileCacheAdvisor::~FileCacheAdvisor()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_ownsDescriptor)
+		close(m_fileDescriptor);
+#endif
+}
+
+void FileCacheAdvisor::WillRead(size_t from, size_t bytes)
+{
+#ifdef POSIX_FADV_WILLNEED
+	if (m_policy != CachePolicy::drop || m_fileDescriptor < 0 || bytes == 0)
+		return;
+
+	// @note Current range is about to be read synchronously anyway, so ask only for the next one.
+	posix_fadvise(m_fileDescriptor, static_cast<off_t>(from + bytes), static_cast<off_t>(bytes), POSIX_FADV_WILLNEED);
+#else
+	(void)from;
+	(void)bytes;
+#endif
+}
+
+void FileCacheAdvisor::Consumed(size_t from, size_t bytes)
+{
+#ifdef POSIX_FADV_DONTNEED
+	if (m_policy != CachePolicy::drop || m_fileDescriptor < 0 || bytes == 0)
+		return;
+
+	posix_fadvise(m_fileDescriptor, static_cast<off_t>(from), static_cast<off_t>(bytes), POSIX_FADV_DONTNEED);
+#else
+	(void)from;
+	(void)bytes;
+#endif
+}
@@ -0,0 +1,43 @@
+#ifndef FILE_CACHE_ADVISOR_H
+#define FILE_CACHE_ADVISOR_H
+
+#include <cstddef>
+#include <string>
+
+/// @brief How reading of the input affects page cache.
+enum class CachePolicy
+{
+	/// @brief Kernel heuristics decide, everything read stays cached.
+	keep,
+	/// @brief Prefetch ahead of reading frontier, evict pages behind it.
+	drop,
+	/// @brief Read with O_DIRECT, page cache is not used at all.
+	bypass
+};
+
+/// @brief Steers kernel readahead and eviction for sequentially read file.
+/// @note Does nothing for CachePolicy::keep and on platforms without posix_fadvise.
+class FileCacheAdvisor
+{
+public:
+	/// @param fileDescriptor is not owned by advisor and must outlive it.
+	FileCacheAdvisor(int fileDescriptor, CachePolicy policy);
+	/// @brief Opens own descriptor, for providers which do not expose one (e.g. std::ifstream).
+	FileCacheAdvisor(const std::string & filePath, CachePolicy policy);
+	~FileCacheAdvisor();
+
+	FileCacheAdvisor(const FileCacheAdvisor &) = delete;
+	FileCacheAdvisor & operator=(const FileCacheAdvisor &) = delete;
+
+	/// @brief Called before [from, from + bytes) is read. Requests the following range in background.
+	void WillRead(size_t from, size_t bytes);
+	/// @brief Called when [from, from + bytes) is not needed anymore. Evicts it from page cache.
+	void Consumed(size_t from, size_t bytes);
+
+private:
+	const CachePolicy m_policy;
+	int m_fileDescriptor {-1};
+	bool m_ownsDescriptor {false};
+};
+
+#endif
@@ -1,8 +1,12 @@
 set(FileDataProviderSources "${CMAKE_CURRENT_LIST_DIR}/IFStreamDataProvider.cpp;${CMAKE_CURRENT_LIST_DIR}/IFStreamDataProvider.h")
+list(APPEND FileDataProviderSources "${CMAKE_CURRENT_LIST_DIR}/FileCacheAdvisor.h;${CMAKE_CURRENT_LIST_DIR}/FileCacheAdvisor.cpp")
 
 # @note Windows do not support unix version of mmap
 if (NOT WIN32)
 	list(APPEND FileDataProviderSources "${CMAKE_CURRENT_LIST_DIR}/MMapDataProvider.h;${CMAKE_CURRENT_LIST_DIR}/MMapDataProvider.cpp")
+	list(APPEND FileDataProviderSources "${CMAKE_CURRENT_LIST_DIR}/DirectDataProvider.h;${CMAKE_CURRENT_LIST_DIR}/DirectDataProvider.cpp")
+	list(APPEND FileDataProviderSources "${CMAKE_CURRENT_LIST_DIR}/PReadDataProvider.h;${CMAKE_CURRENT_LIST_DIR}/PReadDataProvider.cpp")
+	list(APPEND FileDataProviderSources "${CMAKE_CURRENT_LIST_DIR}/StreamDataProvider.h;${CMAKE_CURRENT_LIST_DIR}/StreamDataProvider.cpp")
 endif()
 
 add_library(FileDataProvider SHARED ${FileDataProviderSources})
@@ -2,9 +2,10 @@
 
 #include <boost/filesystem.hpp>
 
-IFStreamDataProvider::IFStreamDataProvider(const std::string & filePath)
+IFStreamDataProvider::IFStreamDataProvider(const std::string & filePath, CachePolicy cachePolicy)
 	: m_filePath(filePath)
 	, m_fileSize(boost::filesystem::file_size(m_filePath))
+	, m_cacheAdvisor(m_filePath, cachePolicy == CachePolicy::keep ? CachePolicy::keep : CachePolicy::drop)
 {
 	m_fileStream.open(m_filePath, std::ios_base::in | std::ifstream::binary);
 	if (!m_fileStream.is_open())
@@ -14,6 +15,17 @@ IFStreamDataProvider::IFStreamDataProvider(const std::string & filePath)
 IFStreamDataProvider::~IFStreamDataProvider() = default;
 
 size_t IFStreamDataProvider::Read(size_t from, size_t bytes)
+{
+	if (from < m_fileSize && bytes > m_fileSize - from)
+		bytes = m_fileSize - from;
+
+	if (from < m_fileSize && m_data.size() < bytes)
+		m_data.resize(bytes);
+
+	return ReadAt(from, bytes, m_data.data());
+}
+
+size_t IFStreamDataProvider::ReadAt(size_t from, size_t bytes, std::uint8_t * buffer)
 {
 	m_fileStream.seekg(from);
 	// @note Trying read from stream. Setting eofbit if needed.
@@ -25,11 +37,13 @@ size_t IFStreamDataProvider::Read(size_t from, size_t bytes)
 	if (bytes > m_fileSize - from)
 		bytes = m_fileSize - from;
 
-	if (m_data.size() < bytes)
-		m_data.resize(bytes);
+	m_cacheAdvisor.WillRead(from, bytes);
 
-	char * begin = reinterpret_cast<char*>(m_data.data());
+	char * begin = reinterpret_cast<char*>(buffer);
 	m_fileStream.read(begin, bytes);
+
+	// @note Data is copied into caller buffer, so cached pages are not needed right after reading.
+	m_cacheAdvisor.Consumed(from, bytes);
 	return bytes;
 }
 
@@ -49,3 +63,8 @@ bool IFStreamDataProvider::Eof()
 {
 	return m_fileStream.eof();
 }
+
+bool IFStreamDataProvider::ConcurrentReads() const
+{
+	return false;
+}
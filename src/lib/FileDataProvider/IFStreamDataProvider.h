@@ -6,18 +6,24 @@
 #include <vector>
 
 #include "IDataProvider.h"
+#include "IPositionalDataProvider.h"
+#include "FileCacheAdvisor.h"
 
-class IFStreamDataProvider : public IDataProvider
+class IFStreamDataProvider : public IDataProvider, public IPositionalDataProvider
 {
 
 public:
-	IFStreamDataProvider(const std::string & filePath);
+	/// @note CachePolicy::bypass is not supported by buffered stream, it is treated as CachePolicy::drop.
+	IFStreamDataProvider(const std::string & filePath, CachePolicy cachePolicy = CachePolicy::keep);
 	~IFStreamDataProvider();
 
 	size_t Read(size_t from, size_t bytes) override;
 	const std::uint8_t * Data() const override;
+	/// @brief Reads directly into caller buffer. Stream position is shared, so reads are not concurrent.
+	size_t ReadAt(size_t from, size_t bytes, std::uint8_t * buffer) override;
 	std::size_t TotalSize() const override;
 	bool Eof() override;
+	bool ConcurrentReads() const override;
 
 private:
 	const std::string m_filePath;
@@ -25,6 +31,7 @@ private:
 	std::vector<std::uint8_t> m_data;
 
 	std::ifstream m_fileStream;
+	FileCacheAdvisor m_cacheAdvisor;
 };
 
 #endif
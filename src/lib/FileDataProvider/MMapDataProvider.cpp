@@ -6,10 +6,12 @@
 
 #include <boost/filesystem.hpp>
 
-MMapDataProvider::MMapDataProvider(const std::string & filePath)
+MMapDataProvider::MMapDataProvider(const std::string & filePath, CachePolicy cachePolicy)
 	: m_filePath(filePath)
 	, m_fileDescriptor(open(m_filePath.data(), O_RDONLY))
 	, m_fileSize(boost::filesystem::file_size(m_filePath))
+	, m_cachePolicy(cachePolicy == CachePolicy::keep ? CachePolicy::keep : CachePolicy::drop)
+	, m_cacheAdvisor(m_fileDescriptor, m_cachePolicy)
 {
 	if (m_fileDescriptor < 0)
 		throw std::runtime_error("Cannot open file: " + m_filePath + " with error: " + std::to_string(errno));
@@ -17,14 +19,13 @@ MMapDataProvider::MMapDataProvider(const std::string & filePath)
 
 MMapDataProvider::~MMapDataProvider()
 {
-	if (m_dataPtr != nullptr)
-		munmap(m_dataPtr, m_previouslyReadBytesSize);
+	Unmap();
 	close(m_fileDescriptor);
 }
 
 size_t MMapDataProvider::Read(size_t from, size_t bytes)
 {
-	if (from > m_fileSize)
+	if (from >= m_fileSize)
 	{
 		m_eof = true;
 		return 0;
@@ -33,20 +34,30 @@ size_t MMapDataProvider::Read(size_t from, size_t bytes)
 	if (bytes > m_fileSize - from)
 		bytes = m_fileSize - from;
 
-	if (m_dataPtr != nullptr)
-		munmap(m_dataPtr, m_previouslyReadBytesSize);
+	Unmap();
+
+	// @note Offset of mapping must be multiple of page size, while blocks may start anywhere.
+	static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t mapFrom = from - from % pageSize;
+	const size_t mapBytes = bytes + (from - mapFrom);
+
+	m_cacheAdvisor.WillRead(mapFrom, mapBytes);
 
 	errno = 0;
-	m_previouslyReadBytesSize = bytes;
-	m_dataPtr = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, m_fileDescriptor, from);
+	m_dataPtr = mmap(nullptr, mapBytes, PROT_READ, MAP_SHARED, m_fileDescriptor, static_cast<off_t>(mapFrom));
 
-	if (errno != 0 || m_dataPtr == MAP_FAILED)
+	if (m_dataPtr == MAP_FAILED)
 	{
 		m_dataPtr = nullptr;
-		m_previouslyReadBytesSize = 0;
 		throw std::runtime_error("Cannot map file. Error code: " + std::to_string(errno));
 	}
 
+	if (m_cachePolicy == CachePolicy::drop)
+		madvise(m_dataPtr, mapBytes, MADV_SEQUENTIAL);
+
+	m_mappedFrom = mapFrom;
+	m_dataOffset = from - mapFrom;
+	m_previouslyReadBytesSize = mapBytes;
 	return bytes;
 }
 
@@ -54,7 +65,7 @@ const std::uint8_t * MMapDataProvider::Data() const
 {
 	if (m_dataPtr == nullptr || m_dataPtr == MAP_FAILED)
 		return nullptr;
-	return reinterpret_cast<uint8_t *>(m_dataPtr);
+	return reinterpret_cast<uint8_t *>(m_dataPtr) + m_dataOffset;
 }
 
 std::size_t MMapDataProvider::TotalSize() const
@@ -66,3 +77,18 @@ bool MMapDataProvider::Eof()
 {
 	return m_eof;
 }
+
+void MMapDataProvider::Unmap()
+{
+	if (m_dataPtr == nullptr)
+		return;
+
+	// @note Page cache keeps pages while they are mapped, so mapping is released before eviction.
+	if (m_cachePolicy == CachePolicy::drop)
+		madvise(m_dataPtr, m_previouslyReadBytesSize, MADV_DONTNEED);
+	munmap(m_dataPtr, m_previouslyReadBytesSize);
+	m_cacheAdvisor.Consumed(m_mappedFrom, m_previouslyReadBytesSize);
+
+	m_dataPtr = nullptr;
+	m_previouslyReadBytesSize = 0;
+}
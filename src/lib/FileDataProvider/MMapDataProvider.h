@@ -4,12 +4,14 @@
 #include <string>
 
 #include "IDataProvider.h"
+#include "FileCacheAdvisor.h"
 
 class MMapDataProvider : public IDataProvider
 {
 
 public:
-	MMapDataProvider(const std::string & filePath);
+	/// @note CachePolicy::bypass is not supported by mapping, it is treated as CachePolicy::drop.
+	MMapDataProvider(const std::string & filePath, CachePolicy cachePolicy = CachePolicy::keep);
 	~MMapDataProvider();
 
 	size_t Read(size_t from, size_t bytes) override;
@@ -18,13 +20,21 @@ public:
 	bool Eof() override;
 
 private:
+	void Unmap();
+
 	const std::string m_filePath;
 	const int m_fileDescriptor;
 	const size_t m_fileSize;
+	const CachePolicy m_cachePolicy;
 	bool m_eof = false;
 
 	void * m_dataPtr = nullptr;
+	/// @note Mapping starts at page boundary, requested data starts m_dataOffset bytes later.
+	size_t m_dataOffset = 0;
+	size_t m_mappedFrom = 0;
 	size_t m_previouslyReadBytesSize = 0;
+
+	FileCacheAdvisor m_cacheAdvisor;
 };
 
 #endif
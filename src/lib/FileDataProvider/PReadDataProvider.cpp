@@ -0,0 +1,90 @@
+#include "PReadDataProvider.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+PReadDataProvider::PReadDataProvider(const std::string & filePath, CachePolicy cachePolicy)
+	: m_filePath(filePath)
+	, m_fileDescriptor(open(m_filePath.data(), O_RDONLY))
+	, m_fileSize(boost::filesystem::file_size(m_filePath))
+	, m_cacheAdvisor(m_fileDescriptor, cachePolicy == CachePolicy::keep ? CachePolicy::keep : CachePolicy::drop)
+{
+	if (m_fileDescriptor < 0)
+		throw std::runtime_error("Cannot open file: " + m_filePath + " with error: " + std::to_string(errno));
+}
+
+PReadDataProvider::~PReadDataProvider()
+{
+	close(m_fileDescriptor);
+}
+
+size_t PReadDataProvider::Read(size_t from, size_t bytes)
+{
+	if (from >= m_fileSize)
+	{
+		m_eof = true;
+		return 0;
+	}
+
+	if (bytes > m_fileSize - from)
+		bytes = m_fileSize - from;
+
+	if (m_data.size() < bytes)
+		m_data.resize(bytes);
+
+	return ReadAt(from, bytes, m_data.data());
+}
+
+const std::uint8_t * PReadDataProvider::Data() const
+{
+	if (m_data.empty())
+		return nullptr;
+	return m_data.data();
+}
+
+size_t PReadDataProvider::ReadAt(size_t from, size_t bytes, std::uint8_t * buffer)
+{
+	if (from >= m_fileSize)
+		return 0;
+
+	if (bytes > m_fileSize - from)
+		bytes = m_fileSize - from;
+
+	m_cacheAdvisor.WillRead(from, bytes);
+
+	size_t done = 0;
+	while (done < bytes)
+	{
+		const ssize_t result = pread(m_fileDescriptor, buffer + done, bytes - done, static_cast<off_t>(from + done));
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			throw std::runtime_error("Cannot read file: " + m_filePath + " with error: " + std::to_string(errno));
+		}
+		if (result == 0)
+			break;
+		done += static_cast<size_t>(result);
+	}
+
+	// @note Data is copied into caller buffer, so cached pages are not needed right after reading.
+	m_cacheAdvisor.Consumed(from, done);
+	return done;
+}
+
+std::size_t PReadDataProvider::TotalSize() const
+{
+	return m_fileSize;
+}
+
+bool PReadDataProvider::Eof()
+{
+	return m_eof;
+}
+
+bool PReadDataProvider::ConcurrentReads() const
+{
+	return true;
+}
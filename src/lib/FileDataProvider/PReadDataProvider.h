@@ -0,0 +1,38 @@
+#ifndef PREAD_DATA_PROVIDER_H
+#define PREAD_DATA_PROVIDER_H
+
+#include <string>
+#include <vector>
+
+#include "IDataProvider.h"
+#include "IPositionalDataProvider.h"
+#include "FileCacheAdvisor.h"
+
+/// @brief Reads file with positional reads (pread), so every worker may read its own block
+/// without shared stream position and without central read window.
+class PReadDataProvider : public IDataProvider, public IPositionalDataProvider
+{
+
+public:
+	/// @note CachePolicy::bypass is not supported, it is treated as CachePolicy::drop.
+	PReadDataProvider(const std::string & filePath, CachePolicy cachePolicy = CachePolicy::keep);
+	~PReadDataProvider();
+
+	size_t Read(size_t from, size_t bytes) override;
+	const std::uint8_t * Data() const override;
+	size_t ReadAt(size_t from, size_t bytes, std::uint8_t * buffer) override;
+	std::size_t TotalSize() const override;
+	bool Eof() override;
+	bool ConcurrentReads() const override;
+
+private:
+	const std::string m_filePath;
+	const int m_fileDescriptor;
+	const size_t m_fileSize;
+	bool m_eof = false;
+	std::vector<std::uint8_t> m_data;
+
+	FileCacheAdvisor m_cacheAdvisor;
+};
+
+#endif
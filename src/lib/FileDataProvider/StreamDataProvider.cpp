@@ -0,0 +1,86 @@
+#include "StreamDataProvider.h"
+
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+int OpenStream(const std::string & filePath)
+{
+	if (filePath == StreamDataProvider::STANDARD_INPUT)
+		return STDIN_FILENO;
+	return open(filePath.data(), O_RDONLY);
+}
+} // namespace
+
+StreamDataProvider::StreamDataProvider(const std::string & filePath)
+	: m_filePath(filePath)
+	, m_fileDescriptor(OpenStream(m_filePath))
+{
+	if (m_fileDescriptor < 0)
+		throw std::runtime_error("Cannot open file: " + m_filePath + " with error: " + std::to_string(errno));
+}
+
+StreamDataProvider::~StreamDataProvider()
+{
+	if (m_fileDescriptor != STDIN_FILENO)
+		close(m_fileDescriptor);
+}
+
+size_t StreamDataProvider::Read(size_t from, size_t bytes)
+{
+	if (m_data.size() < bytes)
+		m_data.resize(bytes);
+
+	return ReadAt(from, bytes, m_data.data());
+}
+
+const std::uint8_t * StreamDataProvider::Data() const
+{
+	if (m_data.empty())
+		return nullptr;
+	return m_data.data();
+}
+
+size_t StreamDataProvider::ReadAt(size_t from, size_t bytes, std::uint8_t * buffer)
+{
+	if (from != m_position)
+		throw std::logic_error("Stream: " + m_filePath + " may be read only sequentially.");
+
+	// @note Pipe returns data in chunks of its own size, so block is collected by several reads.
+	size_t done = 0;
+	while (done < bytes && !m_eof)
+	{
+		const ssize_t result = read(m_fileDescriptor, buffer + done, bytes - done);
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			throw std::runtime_error("Cannot read stream: " + m_filePath + " with error: " + std::to_string(errno));
+		}
+		if (result == 0)
+			m_eof = true;
+		done += static_cast<size_t>(result);
+	}
+
+	m_position += done;
+	return done;
+}
+
+std::size_t StreamDataProvider::TotalSize() const
+{
+	return UNKNOWN_SIZE;
+}
+
+bool StreamDataProvider::Eof()
+{
+	return m_eof;
+}
+
+bool StreamDataProvider::ConcurrentReads() const
+{
+	return false;
+}
@@ -0,0 +1,38 @@
+#ifndef STREAM_DATA_PROVIDER_H
+#define STREAM_DATA_PROVIDER_H
+
+#include <string>
+#include <vector>
+
+#include "IDataProvider.h"
+#include "IPositionalDataProvider.h"
+
+/// @brief Reads stdin, pipe or any other source which size is not known in advance.
+/// @note Source may be read only sequentially, every read must start where the previous one ended.
+class StreamDataProvider : public IDataProvider, public IPositionalDataProvider
+{
+
+public:
+	/// @param filePath path to FIFO or character device, "-" means standard input.
+	StreamDataProvider(const std::string & filePath);
+	~StreamDataProvider();
+
+	size_t Read(size_t from, size_t bytes) override;
+	const std::uint8_t * Data() const override;
+	size_t ReadAt(size_t from, size_t bytes, std::uint8_t * buffer) override;
+	/// @brief Always returns UNKNOWN_SIZE.
+	std::size_t TotalSize() const override;
+	bool Eof() override;
+	bool ConcurrentReads() const override;
+
+	static constexpr const char * STANDARD_INPUT = "-";
+
+private:
+	const std::string m_filePath;
+	const int m_fileDescriptor;
+	size_t m_position = 0;
+	bool m_eof = false;
+	std::vector<std::uint8_t> m_data;
+};
+
+#endif
@@ -1,5 +1,7 @@
 add_library(FileHashSaver SHARED "${CMAKE_CURRENT_LIST_DIR}/FileHashSaver.cpp"
-									"${CMAKE_CURRENT_LIST_DIR}/FileHashSaver.h")
+									"${CMAKE_CURRENT_LIST_DIR}/FileHashSaver.h"
+									"${CMAKE_CURRENT_LIST_DIR}/PositionalHashSaver.cpp"
+									"${CMAKE_CURRENT_LIST_DIR}/PositionalHashSaver.h")
 target_include_directories(FileHashSaver INTERFACE "${CMAKE_CURRENT_LIST_DIR}")
 
-target_link_libraries(FileHashSaver InterfaceLib)
+target_link_libraries(FileHashSaver InterfaceLib Boost::filesystem)
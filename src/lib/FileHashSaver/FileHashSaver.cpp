@@ -1,5 +1,12 @@
 #include <fstream>
 
+#include <boost/filesystem.hpp>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
 #include "FileHashSaver.h"
 
 FileHashSaver::FileHashSaver(const std::string & filePath)
@@ -10,10 +17,47 @@ FileHashSaver::FileHashSaver(const std::string & filePath)
 		throw std::runtime_error("Cannot open file: " + m_filePath + "; for hash output.");
 }
 
+FileHashSaver::FileHashSaver(const std::string & filePath, std::uint64_t keepBytes)
+	: m_filePath(filePath)
+	, m_size(keepBytes)
+{
+	if (boost::filesystem::file_size(m_filePath) < keepBytes)
+		throw std::runtime_error("File: " + m_filePath + " is shorter than resumed output.");
+
+	boost::filesystem::resize_file(m_filePath, keepBytes);
+	m_fileStream.open(m_filePath, std::ios_base::out | std::ios_base::app);
+	if (!m_fileStream.is_open())
+		throw std::runtime_error("Cannot open file: " + m_filePath + "; for hash output.");
+}
+
 FileHashSaver::~FileHashSaver() = default;
 
 void FileHashSaver::Save(const std::string & hash)
 {
 	m_fileStream << hash;
 	m_fileStream.flush();
+	m_size += hash.size();
+}
+
+void FileHashSaver::Sync()
+{
+	m_fileStream.flush();
+	if (!m_fileStream)
+		throw std::runtime_error("Cannot write file: " + m_filePath + "; for hash output.");
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	// @note std::ofstream does not expose its descriptor, but fsync of any descriptor flushes the whole file.
+	const int fileDescriptor = open(m_filePath.data(), O_WRONLY);
+	if (fileDescriptor < 0)
+		throw std::runtime_error("Cannot open file: " + m_filePath + "; for sync.");
+	const int result = fsync(fileDescriptor);
+	close(fileDescriptor);
+	if (result != 0)
+		throw std::runtime_error("Cannot sync file: " + m_filePath + " with error: " + std::to_string(errno));
+#endif
+}
+
+std::uint64_t FileHashSaver::Size() const
+{
+	return m_size;
 }
@@ -1,6 +1,7 @@
 #ifndef FILE_HASH_SAVER_H
 #define FILE_HASH_SAVER_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <fstream>
@@ -18,13 +19,21 @@ class DLL_EXPORT FileHashSaver : public IHashSaver
 
 public:
 	FileHashSaver(const std::string & file_path);
+	/// @brief Continues previously interrupted output.
+	/// @param keepBytes size of the output which is known to be valid. Everything after it is discarded.
+	FileHashSaver(const std::string & file_path, std::uint64_t keepBytes);
 	~FileHashSaver();
 
 	void Save(const std::string & hash) override;
+	void Sync() override;
+
+	/// @brief Returns size of the output including resumed part.
+	std::uint64_t Size() const;
 
 private:
 	const std::string m_filePath;
 	std::ofstream m_fileStream;
+	std::uint64_t m_size {0};
 };
 
 #undef DLL_EXPORT
@@ -0,0 +1,167 @@
+#include "PositionalHashSaver.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+namespace
+{
+void WriteAt(int fileDescriptor, const std::string & filePath, const char * data, size_t size, std::uint64_t offset)
+{
+	while (size > 0)
+	{
+		const ssize_t written = pwrite(fileDescriptor, data, size, static_cast<off_t>(offset));
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			throw std::runtime_error("Cannot write file: " + filePath + " with error: " + std::to_string(errno));
+		data += written;
+		size -= static_cast<size_t>(written);
+		offset += static_cast<std::uint64_t>(written);
+	}
+}
+} // namespace
+
+PositionalHashSaver::PositionalHashSaver(const std::string & filePath, size_t hashSize, const std::string & header, std::uint64_t firstBlock, bool keepContent)
+	: m_filePath(filePath)
+	, m_hashSize(hashSize)
+	, m_headerSize(header.size())
+	, m_firstBlock(firstBlock)
+	, m_nextBlock(firstBlock)
+{
+	if (m_hashSize < 1)
+		throw std::invalid_argument("Invalid hash size.");
+
+	m_fileDescriptor = open(m_filePath.data(), O_RDWR | O_CREAT | (keepContent ? 0 : O_TRUNC), 0644);
+	if (m_fileDescriptor < 0)
+		throw std::runtime_error("Cannot open file: " + m_filePath + "; for hash output.");
+
+	// @note Header of resumed output is the same, so it is simply written again.
+	try
+	{
+		WriteAt(m_fileDescriptor, m_filePath, header.data(), header.size(), 0);
+	}
+	catch (...)
+	{
+		close(m_fileDescriptor);
+		throw;
+	}
+}
+
+PositionalHashSaver::~PositionalHashSaver()
+{
+	if (m_mapping != nullptr)
+		munmap(m_mapping, static_cast<size_t>(m_mappingSize));
+	close(m_fileDescriptor);
+}
+
+void PositionalHashSaver::Sync()
+{
+	if (m_mapping != nullptr && msync(m_mapping, static_cast<size_t>(m_mappingSize), MS_SYNC) != 0)
+		throw std::runtime_error("Cannot sync file: " + m_filePath + " with error: " + std::to_string(errno));
+	if (fsync(m_fileDescriptor) != 0)
+		throw std::runtime_error("Cannot sync file: " + m_filePath + " with error: " + std::to_string(errno));
+}
+
+void PositionalHashSaver::SaveAt(std::uint64_t block, const std::string & hash)
+{
+	if (hash.size() != m_hashSize)
+		throw std::runtime_error("Hash of " + std::to_string(hash.size()) + " symbols does not fit record of " + std::to_string(m_hashSize) + " symbols.");
+	if (block < m_firstBlock)
+		throw std::out_of_range("Block " + std::to_string(block) + " is before the first block of output.");
+
+	const std::uint64_t offset = Size(block);
+	if (m_mapping != nullptr && offset + hash.size() <= m_mappingSize)
+		std::memcpy(m_mapping + offset, hash.data(), hash.size());
+	else
+		WriteAt(m_fileDescriptor, m_filePath, hash.data(), hash.size(), offset);
+}
+
+void PositionalHashSaver::Reserve(std::uint64_t endBlock)
+{
+	const std::uint64_t size = Size(std::max(endBlock, m_firstBlock));
+
+	struct stat status {};
+	if (fstat(m_fileDescriptor, &status) != 0)
+		throw std::runtime_error("Cannot get size of file: " + m_filePath + " with error: " + std::to_string(errno));
+
+	// @note Output of interrupted run with other parameters may be longer, it is cut to the exact size.
+	if (static_cast<std::uint64_t>(status.st_size) > size && ftruncate(m_fileDescriptor, static_cast<off_t>(size)) != 0)
+		throw std::runtime_error("Cannot resize file: " + m_filePath + " with error: " + std::to_string(errno));
+
+	bool allocated = false;
+#if defined(__linux__)
+	// @note Space is allocated at once, so concurrent writes at scattered offsets do not fragment the file.
+	const int result = size > 0 ? posix_fallocate(m_fileDescriptor, 0, static_cast<off_t>(size)) : 0;
+	if (result != 0 && result != EOPNOTSUPP && result != EINVAL)
+		throw std::runtime_error("Cannot allocate file: " + m_filePath + " with error: " + std::to_string(result));
+	allocated = result == 0;
+#endif
+	// @note File system without allocation support gets sparse file of the final size.
+	if (static_cast<std::uint64_t>(status.st_size) < size && ftruncate(m_fileDescriptor, static_cast<off_t>(size)) != 0)
+		throw std::runtime_error("Cannot resize file: " + m_filePath + " with error: " + std::to_string(errno));
+
+	if (m_mapping != nullptr)
+	{
+		munmap(m_mapping, static_cast<size_t>(m_mappingSize));
+		m_mapping = nullptr;
+		m_mappingSize = 0;
+	}
+	// @note Write to mapped hole fails with signal when disk is full, so only allocated output is mapped.
+	// Output which cannot be mapped (e.g. in 32 bit address space) is still written by pwrite.
+	if (size == 0 || !allocated)
+		return;
+
+	void * mapping = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, m_fileDescriptor, 0);
+	if (mapping == MAP_FAILED)
+		return;
+	m_mapping = static_cast<char *>(mapping);
+	m_mappingSize = size;
+}
+
+#else
+
+PositionalHashSaver::PositionalHashSaver(const std::string &, size_t hashSize, const std::string & header, std::uint64_t firstBlock, bool)
+	: m_hashSize(hashSize)
+	, m_headerSize(header.size())
+	, m_firstBlock(firstBlock)
+	, m_nextBlock(firstBlock)
+{
+	throw std::runtime_error("Positional output is not supported on this platform.");
+}
+
+PositionalHashSaver::~PositionalHashSaver() = default;
+
+void PositionalHashSaver::Sync()
+{
+}
+
+void PositionalHashSaver::SaveAt(std::uint64_t, const std::string &)
+{
+}
+
+void PositionalHashSaver::Reserve(std::uint64_t)
+{
+}
+
+#endif
+
+void PositionalHashSaver::Save(const std::string & hash)
+{
+	SaveAt(m_nextBlock++, hash);
+}
+
+std::uint64_t PositionalHashSaver::Size(std::uint64_t endBlock) const
+{
+	return m_headerSize + (endBlock - m_firstBlock) * m_hashSize;
+}
@@ -0,0 +1,60 @@
+#ifndef POSITIONAL_HASH_SAVER_H
+#define POSITIONAL_HASH_SAVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "IHashSaver.h"
+#include "IPositionalHashSaver.h"
+
+#ifdef __APPLE__
+	#define DLL_EXPORT
+#else
+	#define DLL_EXPORT __declspec(dllexport)
+#endif
+
+/// @brief Output file where hash of block i is placed at header size + (i - first block) * hash size.
+/// Hashes are written by many threads at once, so they need not be saved in block order. Reserved output is mapped into
+/// memory and hash is simply copied to its place, without system call per hash. Output of unknown size is written by pwrite.
+class DLL_EXPORT PositionalHashSaver : public IHashSaver, public IPositionalHashSaver
+{
+
+public:
+	/// @param hashSize size of every hash, hashes of other size are rejected.
+	/// @param header written before the hashes, e.g. header of shard signature.
+	/// @param firstBlock block which hash is the first one in the output.
+	/// @param keepContent continue previously interrupted output, everything written before is kept and overwritten in place.
+	PositionalHashSaver(const std::string & filePath, size_t hashSize, const std::string & header = std::string(),
+						std::uint64_t firstBlock = 0, bool keepContent = false);
+	~PositionalHashSaver();
+
+	PositionalHashSaver(const PositionalHashSaver &) = delete;
+	PositionalHashSaver & operator=(const PositionalHashSaver &) = delete;
+
+	/// @brief Writes hash after the one written by the previous Save call.
+	void Save(const std::string & hash) override;
+	void Sync() override;
+
+	void SaveAt(std::uint64_t block, const std::string & hash) override;
+	void Reserve(std::uint64_t endBlock) override;
+
+	/// @brief Returns size of the output holding header and hashes of all blocks before endBlock.
+	std::uint64_t Size(std::uint64_t endBlock) const;
+
+private:
+	const std::string m_filePath;
+	const size_t m_hashSize;
+	const std::uint64_t m_headerSize;
+	const std::uint64_t m_firstBlock;
+	int m_fileDescriptor {-1};
+	/// @note Mapping of reserved output, nullptr if it is not reserved.
+	char * m_mapping {nullptr};
+	std::uint64_t m_mappingSize {0};
+	std::atomic<std::uint64_t> m_nextBlock;
+};
+
+#undef DLL_EXPORT
+
+#endif // POSITIONAL_HASH_SAVER_H
@@ -11,3 +11,5 @@ target_compile_definitions(md5_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN
 target_link_libraries(md5_test_suite Boost::unit_test_framework
 									 InterfaceLib
 									 MD5HashCalculator)
+
+add_test(NAME md5_test_runner COMMAND md5_test_suite)
@@ -0,0 +1,90 @@
+#include "DigestTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Dedup
+{
+
+std::uint64_t Digest::Mix() const
+{
+	std::uint64_t low = 0;
+	std::uint64_t high = 0;
+	std::memcpy(&low, bytes.data(), sizeof(low));
+	std::memcpy(&high, bytes.data() + sizeof(low), sizeof(high));
+	// @note Digests are uniform, but short ones (crc) fill only a few bytes, so all bits are spread by murmur finalizer.
+	std::uint64_t value = low ^ (high * 0x9E3779B97F4A7C15ULL);
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDULL;
+	value ^= value >> 33;
+	value *= 0xC4CEB9FE1A85EC53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+DigestTable::DigestTable(size_t capacity)
+{
+	if (capacity < 2)
+		throw std::invalid_argument("Invalid digest table capacity.");
+
+	size_t slots = 1;
+	unsigned int bits = 0;
+	while (slots < capacity)
+	{
+		slots <<= 1;
+		++bits;
+	}
+	m_shift = 64 - bits;
+	m_slots.resize(slots);
+	m_sizeLimit = static_cast<size_t>(static_cast<double>(slots) * MAX_LOAD_FACTOR);
+}
+
+bool DigestTable::Insert(const Digest & digest, std::uint32_t file, std::uint64_t block)
+{
+	const size_t mask = m_slots.size() - 1;
+	// @note Slot is taken from the high bits, low bits are left for choosing partition.
+	for (size_t index = static_cast<size_t>(digest.Mix() >> m_shift); ; index = (index + 1) & mask)
+	{
+		Entry & entry = m_slots[index];
+		if (entry.count == 0)
+		{
+			if (m_size >= m_sizeLimit)
+				return false;
+			entry.digest = digest;
+			entry.count = 1;
+			entry.firstBlock = block;
+			entry.firstFile = file;
+			++m_size;
+			return true;
+		}
+		if (entry.digest == digest)
+		{
+			++entry.count;
+			return true;
+		}
+	}
+}
+
+void DigestTable::Clear()
+{
+	std::fill(m_slots.begin(), m_slots.end(), Entry());
+	m_size = 0;
+}
+
+size_t DigestTable::Size() const
+{
+	return m_size;
+}
+
+size_t DigestTable::Capacity() const
+{
+	return m_slots.size();
+}
+
+const std::vector<DigestTable::Entry> & DigestTable::Slots() const
+{
+	return m_slots;
+}
+
+} // namespace Dedup
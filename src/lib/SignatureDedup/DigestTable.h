@@ -0,0 +1,70 @@
+#ifndef DIGEST_TABLE_H
+#define DIGEST_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef __APPLE__
+#define DLL_EXPORT
+#else
+#define DLL_EXPORT __declspec(dllexport)
+#endif
+
+namespace Dedup
+{
+
+/// @brief Binary digest of the block, shorter digests are padded with zeros.
+struct Digest
+{
+	static constexpr size_t MAX_SIZE = 16;
+	std::array<std::uint8_t, MAX_SIZE> bytes {};
+
+	bool operator==(const Digest & other) const { return bytes == other.bytes; }
+	/// @brief Well mixed 64 bit value of the digest, used to choose slot and partition.
+	std::uint64_t Mix() const;
+};
+
+/// @brief Set of digests with number of occurrences and location of the first one.
+/// @note Open addressing with linear probing over one flat array, so probe sequence is read from adjacent cache lines.
+class DLL_EXPORT DigestTable
+{
+public:
+	struct Entry
+	{
+		Digest digest;
+		/// @note Zero count marks empty slot.
+		std::uint64_t count {0};
+		std::uint64_t firstBlock {0};
+		std::uint32_t firstFile {0};
+	};
+
+	/// @note Fill limit, longer probe sequences cost more than the memory saved.
+	static constexpr double MAX_LOAD_FACTOR = 0.85;
+
+	/// @param capacity number of slots, rounded up to power of two.
+	explicit DigestTable(size_t capacity);
+
+	/// @return false if table is full and digest is not in it yet.
+	bool Insert(const Digest & digest, std::uint32_t file, std::uint64_t block);
+	void Clear();
+
+	/// @brief Number of distinct digests.
+	size_t Size() const;
+	size_t Capacity() const;
+	/// @note Empty slots have zero count.
+	const std::vector<Entry> & Slots() const;
+
+private:
+	std::vector<Entry> m_slots;
+	size_t m_size {0};
+	size_t m_sizeLimit {0};
+	unsigned int m_shift {0};
+};
+
+} // namespace Dedup
+
+#undef DLL_EXPORT
+
+#endif
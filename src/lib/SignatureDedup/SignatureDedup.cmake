@@ -0,0 +1,18 @@
+add_library(SignatureDedup SHARED "${CMAKE_CURRENT_LIST_DIR}/DigestTable.cpp"
+								  "${CMAKE_CURRENT_LIST_DIR}/DigestTable.h"
+								  "${CMAKE_CURRENT_LIST_DIR}/SignatureDedup.cpp"
+								  "${CMAKE_CURRENT_LIST_DIR}/SignatureDedup.h")
+target_include_directories(SignatureDedup INTERFACE "${CMAKE_CURRENT_LIST_DIR}")
+
+target_link_libraries(SignatureDedup Boost::filesystem)
+
+add_executable(dedup_test_suite "${CMAKE_CURRENT_LIST_DIR}/unit_tests/dedup_test.cpp")
+
+target_compile_definitions(dedup_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=dedup_test_suite)
+
+target_link_libraries(dedup_test_suite Boost::unit_test_framework
+									   Boost::filesystem
+									   TestHelpers
+									   SignatureDedup)
+
+add_test(NAME dedup_test_runner COMMAND dedup_test_suite)
@@ -0,0 +1,363 @@
+#include "SignatureDedup.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "DigestTable.h"
+
+namespace Dedup
+{
+
+namespace
+{
+const std::string SHARD_MARKER = "#shard";
+const std::string FIRST_BLOCK_FIELD = "first_block=";
+/// @note Upper limit of digests read from signature or partition at once.
+constexpr size_t DIGESTS_PER_READ = 65536;
+/// @note Partitions are planned half full, so uneven split of digests between them still fits.
+constexpr double PLANNED_LOAD_FACTOR = DigestTable::MAX_LOAD_FACTOR / 2;
+/// @note Limit of partition files written at once, more partitions are made by splitting them again.
+constexpr size_t MAX_OPEN_SPILLS = 256;
+/// @note Write buffer of one partition file.
+constexpr size_t SPILL_BUFFER_SIZE = 65536;
+/// @note Partition is chosen by low bits of digest mix, tables never take so many high bits for their slots.
+constexpr unsigned int MAX_PARTITION_BITS = 32;
+
+/// @brief Partition of digests which have the same low bits of mix.
+struct Partition
+{
+	std::string path;
+	/// @note Number of low bits of mix shared by all digests of the partition.
+	unsigned int bits {0};
+	std::uint64_t records {0};
+};
+
+/// @brief Spilled record is binary digest, file index and block index.
+size_t RecordSize(size_t digestLength)
+{
+	return digestLength / 2 + sizeof(std::uint32_t) + sizeof(std::uint64_t);
+}
+
+int HexValue(char symbol)
+{
+	if (symbol >= '0' && symbol <= '9')
+		return symbol - '0';
+	if (symbol >= 'a' && symbol <= 'f')
+		return symbol - 'a' + 10;
+	if (symbol >= 'A' && symbol <= 'F')
+		return symbol - 'A' + 10;
+	return -1;
+}
+
+std::string ToHex(const std::uint8_t * digest, size_t size)
+{
+	static const char SYMBOLS[] = "0123456789abcdef";
+	std::string hex(size * 2, '0');
+	for (size_t i = 0; i < size; ++i)
+	{
+		hex[i * 2] = SYMBOLS[digest[i] >> 4];
+		hex[i * 2 + 1] = SYMBOLS[digest[i] & 0x0F];
+	}
+	return hex;
+}
+
+size_t SlotsFor(std::uint64_t digests, double loadFactor)
+{
+	size_t slots = 2;
+	while (static_cast<double>(slots) * loadFactor < static_cast<double>(digests))
+		slots <<= 1;
+	return slots;
+}
+} // namespace
+
+double DedupReport::Ratio() const
+{
+	return uniqueBlocks > 0 ? static_cast<double>(totalBlocks) / static_cast<double>(uniqueBlocks) : 1.0;
+}
+
+SignatureDedup::SignatureDedup(size_t digestLength, size_t memoryBudget, const std::string & spillDirectory)
+	: m_digestLength(digestLength)
+	, m_memoryBudget(memoryBudget)
+	, m_spillDirectory(spillDirectory.empty() ? boost::filesystem::temp_directory_path().string() : spillDirectory)
+{
+	if (m_digestLength < 2 || m_digestLength % 2 != 0 || m_digestLength > Digest::MAX_SIZE * 2)
+		throw std::invalid_argument("Invalid digest length.");
+
+	// @note Quarter of the budget is enough for buffers, small budgets get smaller buffers, not a smaller table.
+	const size_t ioBudget = m_memoryBudget / 4;
+	const size_t recordSize = RecordSize(m_digestLength);
+	const size_t readSize = std::max(m_digestLength, recordSize);
+	m_readDigests = std::clamp<size_t>(ioBudget / 2 / readSize, 1, DIGESTS_PER_READ);
+	m_spillBufferSize = std::min(SPILL_BUFFER_SIZE, ioBudget / 2 / MAX_OPEN_SPILLS);
+	// @note Buffer smaller than a record saves nothing, such partition files are written unbuffered.
+	if (m_spillBufferSize < recordSize)
+		m_spillBufferSize = 0;
+
+	const size_t buffers = m_readDigests * readSize + MAX_OPEN_SPILLS * m_spillBufferSize;
+	if (m_memoryBudget < buffers + sizeof(DigestTable::Entry) * 2)
+		throw std::invalid_argument("Memory budget is too small.");
+	m_maxSlots = 2;
+	while (m_maxSlots * 2 * sizeof(DigestTable::Entry) <= m_memoryBudget - buffers)
+		m_maxSlots <<= 1;
+}
+
+void SignatureDedup::AddSignature(const std::string & path)
+{
+	std::ifstream file(path, std::ios_base::binary);
+	if (!file.is_open())
+		throw std::runtime_error("Cannot open signature: " + path);
+
+	Signature signature;
+	signature.path = path;
+
+	std::string header;
+	if (file.peek() == SHARD_MARKER.front() && std::getline(file, header) && header.compare(0, SHARD_MARKER.size(), SHARD_MARKER) == 0)
+	{
+		signature.payloadOffset = header.size() + 1;
+		std::istringstream fields(header);
+		std::string field;
+		while (fields >> field)
+			if (field.compare(0, FIRST_BLOCK_FIELD.size(), FIRST_BLOCK_FIELD) == 0)
+				signature.firstBlock = std::stoull(field.substr(FIRST_BLOCK_FIELD.size()));
+	}
+
+	const std::uint64_t payloadSize = boost::filesystem::file_size(path) - signature.payloadOffset;
+	if (payloadSize % m_digestLength != 0)
+		throw std::runtime_error("Signature: " + path + " is not made of digests of " + std::to_string(m_digestLength) + " symbols.");
+	signature.blocks = payloadSize / m_digestLength;
+	m_signatures.push_back(signature);
+}
+
+DedupReport SignatureDedup::Run(const std::function<void(const DuplicateGroup &)> & onDuplicate)
+{
+	const size_t digestSize = m_digestLength / 2;
+
+	DedupReport report;
+	for (const Signature & signature : m_signatures)
+		report.totalBlocks += signature.blocks;
+
+	const auto collect = [this, &report, &onDuplicate, digestSize](DigestTable & table)
+	{
+		for (const DigestTable::Entry & entry : table.Slots())
+		{
+			if (entry.count == 0)
+				continue;
+			++report.uniqueBlocks;
+			if (entry.count < 2)
+				continue;
+			++report.duplicateGroups;
+			if (onDuplicate)
+			{
+				DuplicateGroup group;
+				group.digest = ToHex(entry.digest.bytes.data(), digestSize);
+				group.count = entry.count;
+				group.firstFile = &m_signatures[entry.firstFile].path;
+				group.firstBlock = entry.firstBlock;
+				onDuplicate(group);
+			}
+		}
+		table.Clear();
+	};
+
+	// @note Without partitions number of blocks is exact upper bound of table size, so it may be filled completely.
+	if (static_cast<double>(report.totalBlocks) <= static_cast<double>(m_maxSlots) * DigestTable::MAX_LOAD_FACTOR)
+	{
+		DigestTable table(std::min(m_maxSlots, SlotsFor(report.totalBlocks + 1, DigestTable::MAX_LOAD_FACTOR)));
+		for (std::uint32_t file = 0; file < m_signatures.size(); ++file)
+			ForEachDigest(file, [&table, file, digestSize](const std::uint8_t * bytes, std::uint64_t block)
+			{
+				Digest digest;
+				std::memcpy(digest.bytes.data(), bytes, digestSize);
+				table.Insert(digest, file, block);
+			});
+		collect(table);
+		return report;
+	}
+
+	const size_t recordSize = RecordSize(m_digestLength);
+	const boost::filesystem::path spillPrefix = boost::filesystem::path(m_spillDirectory) / boost::filesystem::unique_path("dedup-%%%%-%%%%-");
+	std::vector<std::string> spillPaths;
+
+	struct SpillCleanup
+	{
+		const std::vector<std::string> & paths;
+		~SpillCleanup()
+		{
+			boost::system::error_code error;
+			for (const std::string & path : paths)
+				boost::filesystem::remove(path, error);
+		}
+	} cleanup {spillPaths};
+
+	using RecordWriter = std::function<void(const char * record)>;
+	// @note Splits records which share given number of low bits of digest mix by the next bits of it.
+	const auto split = [this, &spillPrefix, &spillPaths, recordSize, digestSize](unsigned int bits, std::uint64_t records, const std::function<void(const RecordWriter &)> & forEachRecord)
+	{
+		unsigned int splitBits = 1;
+		while ((size_t(1) << splitBits) < MAX_OPEN_SPILLS
+			   && static_cast<double>(records) / static_cast<double>(size_t(1) << splitBits) > static_cast<double>(m_maxSlots) * PLANNED_LOAD_FACTOR)
+			++splitBits;
+		if (bits + splitBits > MAX_PARTITION_BITS)
+			throw std::runtime_error("Digests of partition do not fit into memory budget, it is split into " + std::to_string(size_t(1) << bits) + " partitions.");
+
+		const size_t count = size_t(1) << splitBits;
+		std::vector<Partition> partitions(count);
+		std::vector<char> buffers(count * m_spillBufferSize);
+		std::vector<std::unique_ptr<std::ofstream>> spills;
+		for (size_t i = 0; i < count; ++i)
+		{
+			partitions[i].path = spillPrefix.string() + std::to_string(spillPaths.size());
+			partitions[i].bits = bits + splitBits;
+			spillPaths.push_back(partitions[i].path);
+			spills.push_back(std::make_unique<std::ofstream>());
+			// @note Buffer is set before the file is opened, so the stream does not allocate its own one.
+			spills.back()->rdbuf()->pubsetbuf(m_spillBufferSize > 0 ? buffers.data() + i * m_spillBufferSize : nullptr, static_cast<std::streamsize>(m_spillBufferSize));
+			spills.back()->open(partitions[i].path, std::ios_base::binary | std::ios_base::trunc);
+			if (!spills.back()->is_open())
+				throw std::runtime_error("Cannot create partition: " + partitions[i].path);
+		}
+
+		forEachRecord([&spills, &partitions, bits, count, digestSize, recordSize](const char * record)
+		{
+			Digest digest;
+			std::memcpy(digest.bytes.data(), record, digestSize);
+			const size_t index = static_cast<size_t>(digest.Mix() >> bits) & (count - 1);
+			spills[index]->write(record, static_cast<std::streamsize>(recordSize));
+			++partitions[index].records;
+		});
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			spills[i]->close();
+			if (!*spills[i])
+				throw std::runtime_error("Cannot write partition: " + partitions[i].path);
+		}
+		return partitions;
+	};
+
+	// @note Reads records of partition until callback asks to stop.
+	const auto read = [this, recordSize](const std::string & path, const std::function<bool(const char * record)> & onRecord)
+	{
+		std::ifstream spill;
+		spill.rdbuf()->pubsetbuf(nullptr, 0);
+		spill.open(path, std::ios_base::binary);
+		if (!spill.is_open())
+			throw std::runtime_error("Cannot open partition: " + path);
+
+		std::vector<char> records(recordSize * m_readDigests);
+		while (spill)
+		{
+			spill.read(records.data(), static_cast<std::streamsize>(records.size()));
+			const size_t count = static_cast<size_t>(spill.gcount()) / recordSize;
+			for (size_t i = 0; i < count; ++i)
+				if (!onRecord(records.data() + i * recordSize))
+					return;
+		}
+	};
+
+	std::vector<Partition> pending = split(0, report.totalBlocks, [this, recordSize, digestSize](const RecordWriter & write)
+	{
+		std::vector<char> record(recordSize);
+		for (std::uint32_t file = 0; file < m_signatures.size(); ++file)
+			ForEachDigest(file, [&write, &record, file, digestSize](const std::uint8_t * bytes, std::uint64_t block)
+			{
+				std::memcpy(record.data(), bytes, digestSize);
+				std::memcpy(record.data() + digestSize, &file, sizeof(file));
+				std::memcpy(record.data() + digestSize + sizeof(file), &block, sizeof(block));
+				write(record.data());
+			});
+	});
+
+	// @note Identical digests always go to the same partition, so every partition is counted independently.
+	// Number of records is only upper bound of distinct digests, so partition is split again only if it does not fit.
+	DigestTable table(m_maxSlots);
+	while (!pending.empty())
+	{
+		const Partition partition = pending.back();
+		pending.pop_back();
+		if (partition.records == 0)
+		{
+			boost::system::error_code error;
+			boost::filesystem::remove(partition.path, error);
+			continue;
+		}
+
+		bool fits = true;
+		read(partition.path, [&table, &fits, digestSize](const char * record)
+		{
+			Digest digest;
+			std::uint32_t file = 0;
+			std::uint64_t block = 0;
+			std::memcpy(digest.bytes.data(), record, digestSize);
+			std::memcpy(&file, record + digestSize, sizeof(file));
+			std::memcpy(&block, record + digestSize + sizeof(file), sizeof(block));
+			fits = table.Insert(digest, file, block);
+			return fits;
+		});
+
+		if (fits)
+		{
+			collect(table);
+		}
+		else
+		{
+			table.Clear();
+			const std::vector<Partition> parts = split(partition.bits, partition.records, [&read, &partition](const RecordWriter & write)
+			{
+				read(partition.path, [&write](const char * record)
+				{
+					write(record);
+					return true;
+				});
+			});
+			pending.insert(pending.end(), parts.begin(), parts.end());
+		}
+		boost::system::error_code error;
+		boost::filesystem::remove(partition.path, error);
+	}
+
+	return report;
+}
+
+void SignatureDedup::ForEachDigest(std::uint32_t file, const std::function<void(const std::uint8_t * digest, std::uint64_t block)> & onDigest) const
+{
+	const Signature & signature = m_signatures[file];
+	// @note Digests are read in chunks into own buffer, so the stream is left unbuffered.
+	std::ifstream stream;
+	stream.rdbuf()->pubsetbuf(nullptr, 0);
+	stream.open(signature.path, std::ios_base::binary);
+	if (!stream.is_open())
+		throw std::runtime_error("Cannot open signature: " + signature.path);
+	stream.seekg(static_cast<std::streamoff>(signature.payloadOffset));
+
+	std::vector<char> text(m_digestLength * m_readDigests);
+	std::array<std::uint8_t, Digest::MAX_SIZE> digest {};
+	for (std::uint64_t block = 0; block < signature.blocks; )
+	{
+		const size_t digests = static_cast<size_t>(std::min<std::uint64_t>(m_readDigests, signature.blocks - block));
+		if (!stream.read(text.data(), static_cast<std::streamsize>(digests * m_digestLength)))
+			throw std::runtime_error("Cannot read signature: " + signature.path);
+
+		for (size_t i = 0; i < digests; ++i, ++block)
+		{
+			const char * hex = text.data() + i * m_digestLength;
+			for (size_t byte = 0; byte < m_digestLength / 2; ++byte)
+			{
+				const int high = HexValue(hex[byte * 2]);
+				const int low = HexValue(hex[byte * 2 + 1]);
+				if (high < 0 || low < 0)
+					throw std::runtime_error("Signature: " + signature.path + " has broken digest of block " + std::to_string(signature.firstBlock + block) + ".");
+				digest[byte] = static_cast<std::uint8_t>((high << 4) | low);
+			}
+			onDigest(digest.data(), signature.firstBlock + block);
+		}
+	}
+}
+
+} // namespace Dedup
@@ -0,0 +1,87 @@
+#ifndef SIGNATURE_DEDUP_H
+#define SIGNATURE_DEDUP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+#define DLL_EXPORT
+#else
+#define DLL_EXPORT __declspec(dllexport)
+#endif
+
+namespace Dedup
+{
+
+struct DedupReport
+{
+	std::uint64_t totalBlocks {0};
+	std::uint64_t uniqueBlocks {0};
+	/// @brief Number of digests met more than once.
+	std::uint64_t duplicateGroups {0};
+
+	/// @brief Ratio of all blocks to the unique ones, 1 means there is nothing to deduplicate.
+	double Ratio() const;
+};
+
+/// @brief Group of identical blocks.
+struct DuplicateGroup
+{
+	std::string digest;
+	std::uint64_t count {0};
+	/// @brief Signature file and block index of the first block of the group.
+	const std::string * firstFile {nullptr};
+	std::uint64_t firstBlock {0};
+};
+
+/// @brief Finds identical blocks in one or many signatures.
+/// Digests are kept in binary form in open addressing table. If table of all blocks does not fit into memory budget,
+/// digests are split into partitions by their value, spilled to disk and counted partition by partition.
+/// Partition which still does not fit is split again, so only a limited number of partition files is open at once.
+class DLL_EXPORT SignatureDedup
+{
+public:
+	static constexpr size_t DEFAULT_MEMORY_BUDGET = 1073741824;
+
+	/// @param digestLength length of one hex digest in the signature.
+	/// @param spillDirectory directory for partitions, system temporary directory is used if it is empty.
+	SignatureDedup(size_t digestLength, size_t memoryBudget = DEFAULT_MEMORY_BUDGET, const std::string & spillDirectory = std::string());
+
+	/// @note Shard signatures are accepted, block indexes are then counted from the first block of the shard.
+	void AddSignature(const std::string & path);
+
+	/// @param onDuplicate called once for every group of identical blocks.
+	/// @note Throws exception if signature is broken or digests cannot be split into partitions which fit into memory budget.
+	DedupReport Run(const std::function<void(const DuplicateGroup &)> & onDuplicate);
+
+private:
+	struct Signature
+	{
+		std::string path;
+		/// @note Position of the first digest, non-zero for shard signatures.
+		std::uint64_t payloadOffset {0};
+		std::uint64_t firstBlock {0};
+		std::uint64_t blocks {0};
+	};
+
+	/// @brief Reads all digests of the signature.
+	void ForEachDigest(std::uint32_t file, const std::function<void(const std::uint8_t * digest, std::uint64_t block)> & onDigest) const;
+
+	const size_t m_digestLength;
+	const size_t m_memoryBudget;
+	const std::string m_spillDirectory;
+	/// @note Buffers of reading and of partition files are taken from the memory budget, the rest is left to the table.
+	size_t m_readDigests {0};
+	size_t m_spillBufferSize {0};
+	size_t m_maxSlots {0};
+	std::vector<Signature> m_signatures;
+};
+
+} // namespace Dedup
+
+#undef DLL_EXPORT
+
+#endif
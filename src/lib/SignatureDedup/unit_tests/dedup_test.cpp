@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "DigestTable.h"
+#include "SignatureDedup.h"
+
+#include "TestFiles.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <sys/resource.h>
+#endif
+
+namespace
+{
+using TestHelpers::SignatureFile;
+
+const std::string A = "0123456789abcdef0123456789abcdef";
+const std::string B = "fedcba9876543210fedcba9876543210";
+const std::string C = "00000000000000000000000000000001";
+
+/// @brief Short crc digests, every fourth block repeats one of 25 digests.
+std::string CrcSignature(unsigned int blocks)
+{
+	std::string content;
+	for (unsigned int i = 0; i < blocks; ++i)
+	{
+		char digest[9] = {};
+		std::snprintf(digest, sizeof(digest), "%08x", i % 4 == 0 ? i % 100 : i);
+		content += digest;
+	}
+	return content;
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+/// @brief Lowers limit of open files while it exists.
+struct OpenFilesLimit
+{
+	explicit OpenFilesLimit(rlim_t limit)
+	{
+		BOOST_REQUIRE(getrlimit(RLIMIT_NOFILE, &previous) == 0);
+		rlimit lowered = previous;
+		lowered.rlim_cur = std::min(limit, previous.rlim_cur);
+		BOOST_REQUIRE(setrlimit(RLIMIT_NOFILE, &lowered) == 0);
+	}
+	~OpenFilesLimit()
+	{
+		setrlimit(RLIMIT_NOFILE, &previous);
+	}
+
+	rlimit previous {};
+};
+#endif
+
+Dedup::Digest MakeDigest(std::uint64_t value)
+{
+	Dedup::Digest digest;
+	for (size_t i = 0; i < sizeof(value); ++i)
+		digest.bytes[i] = static_cast<std::uint8_t>(value >> (i * 8));
+	return digest;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(digest_table_counts_duplicates)
+{
+	Dedup::DigestTable table(16);
+	BOOST_CHECK(table.Insert(MakeDigest(1), 0, 0));
+	BOOST_CHECK(table.Insert(MakeDigest(2), 0, 1));
+	BOOST_CHECK(table.Insert(MakeDigest(1), 1, 7));
+
+	BOOST_CHECK_EQUAL(table.Size(), 2u);
+	for (const Dedup::DigestTable::Entry & entry : table.Slots())
+	{
+		if (entry.digest == MakeDigest(1))
+		{
+			BOOST_CHECK_EQUAL(entry.count, 2u);
+			BOOST_CHECK_EQUAL(entry.firstFile, 0u);
+			BOOST_CHECK_EQUAL(entry.firstBlock, 0u);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(digest_table_refuses_new_digest_when_full)
+{
+	Dedup::DigestTable table(8);
+	size_t inserted = 0;
+	while (table.Insert(MakeDigest(inserted + 1), 0, inserted))
+		++inserted;
+
+	BOOST_CHECK_EQUAL(inserted, table.Size());
+	BOOST_CHECK(inserted < table.Capacity());
+	BOOST_CHECK(table.Insert(MakeDigest(1), 0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(dedup_of_signature_without_duplicates)
+{
+	const SignatureFile signature(A + B + C);
+	Dedup::SignatureDedup dedup(A.size());
+	dedup.AddSignature(signature.path);
+
+	size_t groups = 0;
+	const Dedup::DedupReport report = dedup.Run([&groups](const Dedup::DuplicateGroup &) { ++groups; });
+
+	BOOST_CHECK_EQUAL(report.totalBlocks, 3u);
+	BOOST_CHECK_EQUAL(report.uniqueBlocks, 3u);
+	BOOST_CHECK_EQUAL(report.duplicateGroups, 0u);
+	BOOST_CHECK_EQUAL(groups, 0u);
+	BOOST_CHECK_CLOSE(report.Ratio(), 1.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(dedup_across_signatures_and_shards)
+{
+	const SignatureFile first(A + B + A);
+	const SignatureFile shard("#shard algorithm=md5 block_size=4096 first_block=10 block_count=2 total_blocks=12\n" + C + A);
+	Dedup::SignatureDedup dedup(A.size());
+	dedup.AddSignature(first.path);
+	dedup.AddSignature(shard.path);
+
+	std::vector<Dedup::DuplicateGroup> groups;
+	const Dedup::DedupReport report = dedup.Run([&groups](const Dedup::DuplicateGroup & group) { groups.push_back(group); });
+
+	BOOST_CHECK_EQUAL(report.totalBlocks, 5u);
+	BOOST_CHECK_EQUAL(report.uniqueBlocks, 3u);
+	BOOST_CHECK_EQUAL(report.duplicateGroups, 1u);
+	BOOST_CHECK_CLOSE(report.Ratio(), 5.0 / 3.0, 1e-9);
+	BOOST_REQUIRE_EQUAL(groups.size(), 1u);
+	BOOST_CHECK_EQUAL(groups.front().digest, A);
+	BOOST_CHECK_EQUAL(groups.front().count, 3u);
+	BOOST_CHECK_EQUAL(*groups.front().firstFile, first.path);
+	BOOST_CHECK_EQUAL(groups.front().firstBlock, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(dedup_spilled_to_partitions_gives_same_report)
+{
+	const SignatureFile signature(CrcSignature(20000));
+
+	Dedup::SignatureDedup inMemory(8);
+	inMemory.AddSignature(signature.path);
+	const Dedup::DedupReport expected = inMemory.Run(nullptr);
+
+	Dedup::SignatureDedup spilled(8, 64 * sizeof(Dedup::DigestTable::Entry));
+	spilled.AddSignature(signature.path);
+	std::uint64_t duplicateBlocks = 0;
+	const Dedup::DedupReport report = spilled.Run([&duplicateBlocks](const Dedup::DuplicateGroup & group) { duplicateBlocks += group.count; });
+
+	BOOST_CHECK_EQUAL(report.totalBlocks, expected.totalBlocks);
+	BOOST_CHECK_EQUAL(report.uniqueBlocks, expected.uniqueBlocks);
+	BOOST_CHECK_EQUAL(report.duplicateGroups, expected.duplicateGroups);
+	BOOST_CHECK_EQUAL(report.duplicateGroups, 25u);
+	BOOST_CHECK_EQUAL(duplicateBlocks, report.totalBlocks - report.uniqueBlocks + report.duplicateGroups);
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+BOOST_AUTO_TEST_CASE(dedup_split_into_many_partitions_keeps_few_files_open)
+{
+	const SignatureFile signature(CrcSignature(40000));
+	Dedup::SignatureDedup inMemory(8);
+	inMemory.AddSignature(signature.path);
+	const Dedup::DedupReport expected = inMemory.Run(nullptr);
+
+	const TestHelpers::TemporaryDirectory spillDirectory;
+	Dedup::DedupReport report;
+	{
+		// @note Thousands of partitions are needed for so small budget, far more than files may be open.
+		const OpenFilesLimit limit(300);
+		Dedup::SignatureDedup spilled(8, 64 * sizeof(Dedup::DigestTable::Entry), spillDirectory.path.string());
+		spilled.AddSignature(signature.path);
+		report = spilled.Run(nullptr);
+	}
+
+	BOOST_CHECK_EQUAL(report.totalBlocks, expected.totalBlocks);
+	BOOST_CHECK_EQUAL(report.uniqueBlocks, expected.uniqueBlocks);
+	BOOST_CHECK_EQUAL(report.duplicateGroups, expected.duplicateGroups);
+	BOOST_CHECK(boost::filesystem::is_empty(spillDirectory.path));
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(dedup_of_identical_blocks_in_small_budget)
+{
+	// @note Number of blocks asks for partitions, but all of them are one digest which fits into any table.
+	std::string content;
+	for (unsigned int i = 0; i < 20000; ++i)
+		content += A;
+	const SignatureFile signature(content);
+
+	Dedup::SignatureDedup dedup(A.size(), 64 * sizeof(Dedup::DigestTable::Entry));
+	dedup.AddSignature(signature.path);
+	std::vector<Dedup::DuplicateGroup> groups;
+	const Dedup::DedupReport report = dedup.Run([&groups](const Dedup::DuplicateGroup & group) { groups.push_back(group); });
+
+	BOOST_CHECK_EQUAL(report.totalBlocks, 20000u);
+	BOOST_CHECK_EQUAL(report.uniqueBlocks, 1u);
+	BOOST_REQUIRE_EQUAL(groups.size(), 1u);
+	BOOST_CHECK_EQUAL(groups.front().digest, A);
+	BOOST_CHECK_EQUAL(groups.front().count, 20000u);
+}
+
+BOOST_AUTO_TEST_CASE(dedup_rejects_broken_signature)
+{
+	const SignatureFile truncated(A + "0123");
+	Dedup::SignatureDedup dedup(A.size());
+	BOOST_CHECK_THROW(dedup.AddSignature(truncated.path), std::runtime_error);
+
+	const SignatureFile notHex(A + "0123456789abcdef0123456789abcdeZ");
+	dedup.AddSignature(notHex.path);
+	BOOST_CHECK_THROW(dedup.Run(nullptr), std::runtime_error);
+}
@@ -0,0 +1,69 @@
+#include "BlockBufferPool.h"
+
+#include <new>
+#include <stdexcept>
+
+namespace Calculator
+{
+
+namespace
+{
+size_t AlignedSize(size_t size)
+{
+	return (size + BlockBufferPool::ALIGNMENT - 1) / BlockBufferPool::ALIGNMENT * BlockBufferPool::ALIGNMENT;
+}
+} // namespace
+
+void BlockBufferPool::AlignedDeleter::operator()(std::uint8_t * data) const
+{
+	::operator delete(data, std::align_val_t(ALIGNMENT));
+}
+
+BlockBufferPool::BlockBufferPool(size_t bufferSize, size_t buffersCount)
+	: m_bufferSize(bufferSize)
+	, m_buffersCount(buffersCount)
+{
+	if (bufferSize < 1 || buffersCount < 1)
+		throw std::invalid_argument("Invalid buffer pool size.");
+
+	// @note Every buffer starts at aligned address, so it may be used for direct I/O.
+	const size_t stride = AlignedSize(m_bufferSize);
+	m_storage.reset(static_cast<std::uint8_t *>(::operator new(stride * m_buffersCount, std::align_val_t(ALIGNMENT))));
+
+	m_freeBuffers.reserve(m_buffersCount);
+	for (size_t i = m_buffersCount; i > 0; --i)
+		m_freeBuffers.push_back(m_storage.get() + stride * (i - 1));
+}
+
+BlockBufferPool::~BlockBufferPool() = default;
+
+std::uint8_t * BlockBufferPool::Acquire()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_conditionalVariable.wait(lock, [this]() { return !m_freeBuffers.empty(); });
+
+	std::uint8_t * buffer = m_freeBuffers.back();
+	m_freeBuffers.pop_back();
+	return buffer;
+}
+
+void BlockBufferPool::Release(std::uint8_t * buffer)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_freeBuffers.push_back(buffer);
+	}
+	m_conditionalVariable.notify_one();
+}
+
+size_t BlockBufferPool::BufferSize() const
+{
+	return m_bufferSize;
+}
+
+size_t BlockBufferPool::Count() const
+{
+	return m_buffersCount;
+}
+
+} // namespace Calculator
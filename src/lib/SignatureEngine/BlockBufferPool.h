@@ -0,0 +1,47 @@
+#ifndef BLOCK_BUFFER_POOL_H
+#define BLOCK_BUFFER_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Calculator
+{
+
+/// @brief Fixed set of aligned buffers allocated once and recycled.
+/// Reader takes a buffer per block and waits when all of them are being hashed.
+class BlockBufferPool
+{
+public:
+	BlockBufferPool(size_t bufferSize, size_t buffersCount);
+	~BlockBufferPool();
+
+	BlockBufferPool(const BlockBufferPool &) = delete;
+	BlockBufferPool & operator=(const BlockBufferPool &) = delete;
+
+	/// @brief Returns free buffer, blocks until one is released if pool is exhausted.
+	std::uint8_t * Acquire();
+	void Release(std::uint8_t * buffer);
+
+	size_t BufferSize() const;
+	size_t Count() const;
+
+	static constexpr size_t ALIGNMENT = 4096;
+
+private:
+	struct AlignedDeleter { void operator()(std::uint8_t * data) const; };
+
+	const size_t m_bufferSize;
+	const size_t m_buffersCount;
+	std::unique_ptr<std::uint8_t, AlignedDeleter> m_storage;
+
+	std::mutex m_mutex;
+	std::condition_variable m_conditionalVariable;
+	std::vector<std::uint8_t *> m_freeBuffers;
+};
+
+} // namespace Calculator
+
+#endif
@@ -0,0 +1,124 @@
+#include "DataProviderFactory.h"
+
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "IFStreamDataProvider.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include "DirectDataProvider.h"
+	#include "MMapDataProvider.h"
+	#include "PReadDataProvider.h"
+	#include "StreamDataProvider.h"
+#endif
+
+namespace Calculator
+{
+
+std::vector<ProviderType> AvailableProviderTypes()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	return { ProviderType::mmap, ProviderType::ifstream, ProviderType::pread };
+#else
+	return { ProviderType::ifstream };
+#endif
+}
+
+bool IsStreamInput(const std::string & filePath)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (filePath == StreamDataProvider::STANDARD_INPUT)
+		return true;
+
+	boost::system::error_code error;
+	const boost::filesystem::file_status status = boost::filesystem::status(filePath, error);
+	return !error && boost::filesystem::exists(status) && !boost::filesystem::is_regular_file(status) && !boost::filesystem::is_directory(status);
+#else
+	(void)filePath;
+	return false;
+#endif
+}
+
+std::shared_ptr<IDataProvider> CreateDataProvider(ProviderType type, const std::string & filePath, CachePolicy cachePolicy)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (IsStreamInput(filePath))
+		return std::make_shared<StreamDataProvider>(filePath);
+#endif
+
+	if (cachePolicy == CachePolicy::bypass)
+	{
+#if !defined(_WIN32) && !defined(_WIN64)
+		return std::make_shared<DirectDataProvider>(filePath);
+#else
+		throw std::invalid_argument("Direct I/O is not supported on this platform.");
+#endif
+	}
+
+	switch (type)
+	{
+#if !defined(_WIN32) && !defined(_WIN64)
+	case ProviderType::mmap:
+		return std::make_shared<MMapDataProvider>(filePath, cachePolicy);
+	case ProviderType::pread:
+		return std::make_shared<PReadDataProvider>(filePath, cachePolicy);
+#endif
+	case ProviderType::ifstream:
+		return std::make_shared<IFStreamDataProvider>(filePath, cachePolicy);
+	default:
+		break;
+	}
+
+	throw std::invalid_argument("Data provider " + ToString(type) + " is not supported on this platform.");
+}
+
+std::string ToString(ProviderType type)
+{
+	switch (type)
+	{
+	case ProviderType::mmap: return "mmap";
+	case ProviderType::ifstream: return "ifstream";
+	case ProviderType::pread: return "pread";
+	}
+	return "unknown";
+}
+
+bool FromString(const std::string & name, ProviderType & type)
+{
+	for (const ProviderType available : AvailableProviderTypes())
+	{
+		if (ToString(available) == name)
+		{
+			type = available;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string ToString(CachePolicy policy)
+{
+	switch (policy)
+	{
+	case CachePolicy::keep: return "keep";
+	case CachePolicy::drop: return "drop";
+	case CachePolicy::bypass: return "bypass";
+	}
+	return "unknown";
+}
+
+bool FromString(const std::string & name, CachePolicy & policy)
+{
+	for (const CachePolicy available : { CachePolicy::keep, CachePolicy::drop, CachePolicy::bypass })
+	{
+		if (ToString(available) == name)
+		{
+			policy = available;
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace Calculator
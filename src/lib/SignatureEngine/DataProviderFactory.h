@@ -0,0 +1,44 @@
+#ifndef DATA_PROVIDER_FACTORY_H
+#define DATA_PROVIDER_FACTORY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FileCacheAdvisor.h"
+
+class IDataProvider;
+
+namespace Calculator
+{
+
+enum class ProviderType
+{
+	mmap,
+	ifstream,
+	/// @brief Every worker reads its own block with positional read.
+	pread
+};
+
+/// @brief Returns providers which may be used on current platform. Preferred one goes first.
+std::vector<ProviderType> AvailableProviderTypes();
+
+/// @brief Returns true for standard input ("-"), pipes and other sources which size is not known in advance.
+bool IsStreamInput(const std::string & filePath);
+
+/// @brief Opens file with requested provider.
+/// @note Stream input is always read by stream provider, requested type and cache policy are ignored.
+/// @note CachePolicy::bypass needs direct I/O, so it replaces requested provider with direct one.
+/// @note May throw exception
+std::shared_ptr<IDataProvider> CreateDataProvider(ProviderType type, const std::string & filePath, CachePolicy cachePolicy = CachePolicy::keep);
+
+std::string ToString(ProviderType type);
+/// @return false if name does not match any provider available on current platform.
+bool FromString(const std::string & name, ProviderType & type);
+
+std::string ToString(CachePolicy policy);
+bool FromString(const std::string & name, CachePolicy & policy);
+
+} // namespace Calculator
+
+#endif
@@ -0,0 +1,35 @@
+#include "MemoryDataProvider.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+MemoryDataProvider::MemoryDataProvider(const std::uint8_t * data, size_t size)
+	: m_data(data)
+	, m_size(size)
+{
+	if (!m_data && m_size > 0)
+		throw std::invalid_argument("Invalid buffer.");
+}
+
+size_t MemoryDataProvider::Read(size_t from, size_t bytes)
+{
+	m_position = std::min(from, m_size);
+	const size_t readBytes = std::min(bytes, m_size - m_position);
+	m_eof = m_position + readBytes >= m_size;
+	return readBytes;
+}
+
+const std::uint8_t * MemoryDataProvider::Data() const
+{
+	return m_data + m_position;
+}
+
+std::size_t MemoryDataProvider::TotalSize() const
+{
+	return m_size;
+}
+
+bool MemoryDataProvider::Eof()
+{
+	return m_eof;
+}
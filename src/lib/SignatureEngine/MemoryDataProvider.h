@@ -0,0 +1,28 @@
+#ifndef MEMORY_DATA_PROVIDER_H
+#define MEMORY_DATA_PROVIDER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "IDataProvider.h"
+
+/// @brief Provides data of caller buffer without copying it.
+/// @note Buffer must stay valid and unchanged while provider is used.
+class MemoryDataProvider : public IDataProvider
+{
+public:
+	MemoryDataProvider(const std::uint8_t * data, size_t size);
+
+	size_t Read(size_t from, size_t bytes) override;
+	const std::uint8_t * Data() const override;
+	std::size_t TotalSize() const override;
+	bool Eof() override;
+
+private:
+	const std::uint8_t * const m_data;
+	const size_t m_size;
+	size_t m_position {0};
+	bool m_eof {false};
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "Numa.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace Calculator
+{
+
+std::vector<int> ParseCpuList(const std::string & cpuList)
+{
+	std::vector<int> cpus;
+	std::stringstream stream(cpuList);
+	std::string range;
+	while (std::getline(stream, range, ','))
+	{
+		if (range.empty() || range == "\n")
+			continue;
+
+		const size_t dash = range.find('-');
+		const int first = std::stoi(range.substr(0, dash));
+		const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+		if (first < 0 || last < first)
+			throw std::invalid_argument("Invalid cpu range: " + range);
+		for (int cpu = first; cpu <= last; ++cpu)
+			cpus.push_back(cpu);
+	}
+	return cpus;
+}
+
+std::vector<NumaNode> NumaNodes()
+{
+	std::vector<NumaNode> nodes;
+#if defined(__linux__)
+	const boost::filesystem::path nodesDirectory("/sys/devices/system/node");
+	boost::system::error_code error;
+	if (!boost::filesystem::is_directory(nodesDirectory, error))
+		return nodes;
+
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		return nodes;
+
+	for (boost::filesystem::directory_iterator it(nodesDirectory, error), end; !error && it != end; it.increment(error))
+	{
+		const std::string name = it->path().filename().string();
+		if (name.rfind("node", 0) != 0 || name.size() == 4 || name.find_first_not_of("0123456789", 4) != std::string::npos)
+			continue;
+
+		std::ifstream cpuListFile((it->path() / "cpulist").string());
+		std::string cpuList;
+		std::getline(cpuListFile, cpuList);
+
+		NumaNode node;
+		node.id = std::stoi(name.substr(4));
+		std::vector<int> cpus;
+		try
+		{
+			cpus = ParseCpuList(cpuList);
+		}
+		catch (const std::exception &)
+		{
+			// @note Topology which cannot be read is unknown, workers are left unpinned.
+			return {};
+		}
+		for (const int cpu : cpus)
+			if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+				node.cpus.push_back(cpu);
+
+		if (!node.cpus.empty())
+			nodes.push_back(std::move(node));
+	}
+
+	std::sort(nodes.begin(), nodes.end(), [](const NumaNode & left, const NumaNode & right) { return left.id < right.id; });
+#endif
+	return nodes;
+}
+
+bool PinCurrentThread(const std::vector<int> & cpus)
+{
+	if (cpus.empty())
+		return true;
+
+#if defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	for (const int cpu : cpus)
+		CPU_SET(cpu, &cpuSet);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+	return false;
+#endif
+}
+
+} // namespace Calculator
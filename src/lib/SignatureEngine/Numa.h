@@ -0,0 +1,31 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <string>
+#include <vector>
+
+namespace Calculator
+{
+
+struct NumaNode
+{
+	int id {0};
+	/// @brief CPUs of the node which current process is allowed to run on.
+	std::vector<int> cpus;
+};
+
+/// @brief Parses kernel cpu list format, e.g. "0-3,8-11". Memory only node has empty list.
+/// @note Throws exception if list is malformed.
+std::vector<int> ParseCpuList(const std::string & cpuList);
+
+/// @brief Returns NUMA nodes which have at least one CPU available for current process.
+/// @note Returns empty list when topology is unknown (non Linux hosts, sysfs is not mounted).
+std::vector<NumaNode> NumaNodes();
+
+/// @brief Restricts calling thread to given CPUs. Empty list leaves thread unpinned.
+/// @return false if affinity cannot be changed.
+bool PinCurrentThread(const std::vector<int> & cpus);
+
+} // namespace Calculator
+
+#endif
@@ -0,0 +1,497 @@
+#include "SignatureCalculator.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "IHashSaver.h"
+#include "IDataProvider.h"
+#include "IHashCalculator.h"
+#include "IPositionalDataProvider.h"
+#include "IPositionalHashSaver.h"
+
+#include "BlockBufferPool.h"
+#include "Numa.h"
+#include "WorkerPool.h"
+
+#if __x86_64__ || __ppc64__ || __arm64__ || _WIN64
+	#define ENV64BIT
+#else
+	#define ENV32BIT
+#endif
+
+namespace Calculator
+{
+
+namespace
+{
+unsigned int CalculateNumberOfAvailableThreads(const size_t fileSize, const size_t bytesToRead, unsigned int requestedThreads)
+{
+	if (bytesToRead < 1)
+		throw std::invalid_argument("Invalid bytes to read value.");
+
+	unsigned int numberOfAvailableThreads = requestedThreads;
+	if (numberOfAvailableThreads == 0)
+		numberOfAvailableThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	// @note There is no reason to start more workers than there are blocks in the file. Stream of unknown size
+	// may be of any length, so it gets all requested workers.
+	if (fileSize != IDataProvider::UNKNOWN_SIZE)
+	{
+		const size_t numberOfBlocks = std::max<size_t>((fileSize + bytesToRead - 1) / bytesToRead, 1);
+		if (numberOfBlocks < numberOfAvailableThreads)
+			numberOfAvailableThreads = static_cast<unsigned int>(numberOfBlocks);
+	}
+
+#ifdef ENV32BIT
+	constexpr size_t FOUR_GB_IN_BYTES = 4294967296;
+	if (bytesToRead * numberOfAvailableThreads >= FOUR_GB_IN_BYTES)
+	{
+		for(; numberOfAvailableThreads > 1; --numberOfAvailableThreads)
+			if (bytesToRead * numberOfAvailableThreads < FOUR_GB_IN_BYTES)
+				break;
+	}
+#endif
+
+	return numberOfAvailableThreads;
+}
+
+unsigned int CalculateQueueDepth(const size_t bytesToRead, const unsigned int numberOfThreads, const CalculatorSettings & settings)
+{
+	if (settings.queueDepth < 1)
+		throw std::invalid_argument("Invalid queue depth value.");
+
+	unsigned int queueDepth = settings.queueDepth;
+#ifdef ENV32BIT
+	constexpr size_t FOUR_GB_IN_BYTES = 4294967296;
+	for (; queueDepth > 1; --queueDepth)
+		if (bytesToRead * numberOfThreads * queueDepth < FOUR_GB_IN_BYTES)
+			break;
+#else
+	(void)bytesToRead;
+	(void)numberOfThreads;
+#endif
+	return queueDepth;
+}
+
+/// @brief Returns buffer to the pool when task is done, even if hashing has failed.
+struct BufferRelease
+{
+	BlockBufferPool & pool;
+	std::uint8_t * buffer;
+	~BufferRelease() { pool.Release(buffer); }
+};
+}
+
+struct CalculatorManager::WorkerGroup
+{
+	std::shared_ptr<IDataProvider> dataProvider;
+	std::vector<int> cpus;
+	/// @note Declared before workers, so it outlives tasks which release buffers.
+	std::unique_ptr<BlockBufferPool> buffers;
+	std::shared_ptr<WorkerPool> workers;
+
+	/// @note Reader hands hashes of one window at a time to the saver.
+	std::mutex mutex;
+	std::condition_variable conditionalVariable;
+	std::optional<std::vector<std::string>> readyWindow;
+	bool finished {false};
+	std::exception_ptr error;
+};
+
+CalculatorManager::CalculatorManager(const std::shared_ptr<IDataProvider> & dataProvider,
+									 const std::shared_ptr<IHashSaver> & hashSaver,
+									 const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+									 const size_t readSize,
+									 const CalculatorSettings & settings)
+	: CalculatorManager([dataProvider]() { return dataProvider; }, false, hashSaver, hashCalculator, readSize, settings)
+{
+}
+
+CalculatorManager::CalculatorManager(const DataProviderFactory & dataProviderFactory,
+									 const std::shared_ptr<IHashSaver> & hashSaver,
+									 const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+									 const size_t readSize,
+									 const CalculatorSettings & settings)
+	: CalculatorManager(dataProviderFactory, true, hashSaver, hashCalculator, readSize, settings)
+{
+}
+
+CalculatorManager::CalculatorManager(const DataProviderFactory & dataProviderFactory,
+									 bool multipleProvidersAllowed,
+									 const std::shared_ptr<IHashSaver> & hashSaver,
+									 const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+									 const size_t readSize,
+									 const CalculatorSettings & settings)
+	: m_hashSaver(hashSaver)
+	, m_positionalSaver(std::dynamic_pointer_cast<IPositionalHashSaver>(hashSaver))
+	, m_hashCalculator(hashCalculator)
+	, m_bytesToRead(readSize)
+	, m_firstBlock(settings.firstBlock)
+	, m_onCommitted(settings.onCommitted)
+	, m_workerQueue(settings.workerQueue)
+{
+	if (!dataProviderFactory)
+		throw std::invalid_argument("Invalid data provider.");
+	if (!m_hashSaver)
+		throw std::invalid_argument("Invalid hash saver.");
+	if (!m_hashCalculator)
+		throw std::invalid_argument("Invalid hash calculator.");
+
+	const std::shared_ptr<IDataProvider> firstDataProvider = dataProviderFactory();
+	if (!firstDataProvider)
+		throw std::invalid_argument("Invalid data provider.");
+	m_totalSize = firstDataProvider->TotalSize();
+	// @note Shard ends before the end of the file, everything after it is never read.
+	if (settings.endBlock > 0 && m_totalSize != IDataProvider::UNKNOWN_SIZE)
+		m_totalSize = std::min(m_totalSize, settings.endBlock * readSize);
+
+	// @note Stream can be opened only once, so it is always read by single group.
+	const bool streaming = m_totalSize == IDataProvider::UNKNOWN_SIZE;
+	const std::shared_ptr<IPositionalDataProvider> positionalProvider = std::dynamic_pointer_cast<IPositionalDataProvider>(firstDataProvider);
+	if (positionalProvider)
+		m_readMode = positionalProvider->ConcurrentReads() ? ReadMode::workers : ReadMode::pooled;
+	if (streaming && m_readMode != ReadMode::pooled)
+		throw std::invalid_argument("Data provider of unknown size must support sequential reading into caller buffer.");
+	if (settings.memoryLimit > 0 && settings.memoryLimit < readSize)
+		throw std::invalid_argument("Memory limit is smaller than one block.");
+
+	std::vector<NumaNode> nodes;
+	if (settings.numaAware && multipleProvidersAllowed && !streaming && !settings.workerPool)
+		nodes = settings.numaNodes.empty() ? NumaNodes() : settings.numaNodes;
+	// @note Every group holds at least one block, so limit of fewer blocks than nodes leaves fewer groups.
+	if (settings.memoryLimit > 0 && nodes.size() > settings.memoryLimit / readSize)
+		nodes.resize(settings.memoryLimit / readSize);
+	// @note Single node host is served by unpinned workers, just like without NUMA awareness.
+	if (nodes.size() < 2)
+		nodes.assign(1, NumaNode());
+
+	const size_t numberOfGroups = nodes.size();
+	unsigned int requestedThreads = settings.threads;
+	// @note Window is sized to keep all shared workers busy, though other jobs may take some of them.
+	if (settings.workerPool && (requestedThreads == 0 || requestedThreads > settings.workerPool->Size()))
+		requestedThreads = settings.workerPool->Size();
+	if (numberOfGroups > 1)
+	{
+		if (requestedThreads == 0)
+			for (const NumaNode & node : nodes)
+				requestedThreads += static_cast<unsigned int>(node.cpus.size());
+		requestedThreads = static_cast<unsigned int>((requestedThreads + numberOfGroups - 1) / numberOfGroups);
+	}
+
+	// @note Every group gets equal share of the rest of the file, so it needs only equal share of threads.
+	const size_t firstByte = streaming ? 0 : std::min(m_totalSize, m_firstBlock * readSize);
+	const size_t bytesPerGroup = streaming ? IDataProvider::UNKNOWN_SIZE : (m_totalSize - firstByte + numberOfGroups - 1) / numberOfGroups;
+	unsigned int threadsPerGroup = CalculateNumberOfAvailableThreads(bytesPerGroup, readSize, requestedThreads);
+	m_blocksPerRead = static_cast<size_t>(threadsPerGroup) * CalculateQueueDepth(readSize, threadsPerGroup, settings);
+
+	// @note Number of blocks which may be held in memory at once by every group.
+	const size_t blocksInMemory = settings.memoryLimit > 0 ? settings.memoryLimit / numberOfGroups / readSize : 0;
+	if (blocksInMemory > 0 && m_readMode == ReadMode::window)
+		m_blocksPerRead = std::min(m_blocksPerRead, blocksInMemory);
+	// @note Own workers beyond the limit would never get a block, shared ones are limited by blocks in flight below.
+	if (blocksInMemory > 0 && m_readMode == ReadMode::workers)
+		threadsPerGroup = static_cast<unsigned int>(std::min<size_t>(threadsPerGroup, blocksInMemory));
+	// @note Two windows of buffers by default: one is filled while the other one is hashed. Window holds queueDepth
+	// blocks for every worker, so every worker of stream group has blocks to hash too.
+	size_t pooledBuffers = blocksInMemory > 0 ? blocksInMemory : m_blocksPerRead * 2;
+	// @note Workers read blocks into buffers of the job, so the job holds no more blocks than it has buffers, whoever
+	// owns the workers, and buffers are freed with the job. Two blocks per worker: one is hashed while the next one waits.
+	if (m_readMode == ReadMode::workers)
+		pooledBuffers = std::min<size_t>(pooledBuffers, static_cast<size_t>(threadsPerGroup) * 2);
+
+	for (size_t i = 0; i < numberOfGroups; ++i)
+	{
+		auto group = std::make_unique<WorkerGroup>();
+		group->dataProvider = i == 0 ? firstDataProvider : dataProviderFactory();
+		if (!group->dataProvider)
+			throw std::invalid_argument("Invalid data provider.");
+		group->cpus = nodes[i].cpus;
+		if (m_readMode != ReadMode::window)
+			group->buffers = std::make_unique<BlockBufferPool>(readSize, pooledBuffers);
+		group->workers = settings.workerPool ? settings.workerPool : std::make_shared<WorkerPool>(threadsPerGroup, group->cpus);
+		m_groups.push_back(std::move(group));
+	}
+}
+
+CalculatorManager::~CalculatorManager() = default;
+
+size_t CalculatorManager::TotalSize() const
+{
+	return m_totalSize;
+}
+
+void CalculatorManager::Start()
+{
+	m_stopExecution = false;
+	for (const std::unique_ptr<WorkerGroup> & group : m_groups)
+	{
+		group->readyWindow.reset();
+		group->finished = false;
+		group->error = nullptr;
+	}
+
+	// @note Last block of the file may be shorter than block size, but its hash still takes whole record.
+	if (m_positionalSaver && m_totalSize != IDataProvider::UNKNOWN_SIZE)
+		m_positionalSaver->Reserve((m_totalSize + m_bytesToRead - 1) / m_bytesToRead);
+
+	std::vector<std::thread> readers;
+	const auto stopReaders = [this, &readers]()
+	{
+		m_stopExecution = true;
+		for (const std::unique_ptr<WorkerGroup> & group : m_groups)
+		{
+			std::lock_guard<std::mutex> lock(group->mutex);
+			group->conditionalVariable.notify_all();
+		}
+		for (std::thread & reader : readers)
+			reader.join();
+		// @note Tasks refer to this manager, none of them may be left in workers which outlive it.
+		for (const std::unique_ptr<WorkerGroup> & group : m_groups)
+			group->workers->CancelQueue(m_workerQueue);
+	};
+
+	try
+	{
+		for (size_t i = 0; i < m_groups.size(); ++i)
+			readers.emplace_back(&CalculatorManager::ReaderWorker, this, std::ref(*m_groups[i]), i);
+
+		// @note Hashes are saved strictly in file order, window by window, round robin over groups.
+		// Positional saver already has hashes of the window, only its end is moved forward here.
+		size_t nextBlock = m_firstBlock;
+		for (size_t window = 0; ; ++window)
+		{
+			WorkerGroup & group = *m_groups[window % m_groups.size()];
+			std::vector<std::string> hashes;
+			{
+				std::unique_lock<std::mutex> lock(group.mutex);
+				group.conditionalVariable.wait(lock, [&group]() { return group.readyWindow || group.finished; });
+
+				if (!group.readyWindow)
+				{
+					if (group.error)
+						std::rethrow_exception(group.error);
+					break;
+				}
+
+				hashes = std::move(*group.readyWindow);
+				group.readyWindow.reset();
+			}
+			group.conditionalVariable.notify_all();
+
+			if (!m_positionalSaver)
+				for (const std::string & hash : hashes)
+					m_hashSaver->Save(hash);
+
+			nextBlock += hashes.size();
+			if (m_onCommitted)
+				m_onCommitted(nextBlock);
+		}
+	}
+	catch (...)
+	{
+		stopReaders();
+		throw;
+	}
+
+	stopReaders();
+}
+
+void CalculatorManager::ReaderWorker(WorkerGroup & group, size_t groupIndex)
+{
+	// @note Pinned reader touches provider buffers first, so their pages are allocated on the group node.
+	PinCurrentThread(group.cpus);
+
+	try
+	{
+		if (m_readMode == ReadMode::pooled)
+			ReadPooled(group, groupIndex, dynamic_cast<IPositionalDataProvider &>(*group.dataProvider));
+		else
+			ReadWindows(group, groupIndex);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(group.mutex);
+		group.error = std::current_exception();
+	}
+
+	std::lock_guard<std::mutex> lock(group.mutex);
+	group.finished = true;
+	group.conditionalVariable.notify_all();
+}
+
+void CalculatorManager::ReadWindows(WorkerGroup & group, size_t groupIndex)
+{
+	const size_t bytesToRead = m_bytesToRead * m_blocksPerRead;
+	const size_t step = bytesToRead * m_groups.size();
+
+	// @note Positional provider is read by workers themselves into buffers of the job. Nothing is shared
+	// between windows, so the next window is queued while the previous one is still being hashed.
+	const std::shared_ptr<IPositionalDataProvider> positionalProvider = m_readMode == ReadMode::workers
+		? std::dynamic_pointer_cast<IPositionalDataProvider>(group.dataProvider)
+		: nullptr;
+	const size_t windowsInFlight = positionalProvider ? 2 : 1;
+
+	std::vector<WorkerPool::Task> tasks;
+	tasks.reserve(m_blocksPerRead);
+	std::deque<std::vector<std::future<std::string>>> pendingWindows;
+	for (size_t readFrom = m_firstBlock * m_bytesToRead + bytesToRead * groupIndex; readFrom < m_totalSize && !m_stopExecution; readFrom += step)
+	{
+		std::vector<std::future<std::string>> futures;
+		futures.reserve(m_blocksPerRead);
+		if (positionalProvider)
+		{
+			const size_t readBytes = std::min(bytesToRead, m_totalSize - readFrom);
+			for (size_t blockFrom = readFrom; blockFrom < readFrom + readBytes; blockFrom += m_bytesToRead)
+			{
+				const size_t dataSize = std::min(m_bytesToRead, readFrom + readBytes - blockFrom);
+				// @note Waits here while all blocks of the job are in flight, other jobs sharing workers are not delayed.
+				std::uint8_t * buffer = group.buffers->Acquire();
+				tasks.emplace_back([this, provider = positionalProvider.get(), &buffers = *group.buffers, buffer, blockFrom, dataSize]()
+				{
+					const BufferRelease release {buffers, buffer};
+					if (provider->ReadAt(blockFrom, dataSize, buffer) != dataSize)
+						throw std::runtime_error("Unexpected end of input at offset " + std::to_string(blockFrom) + ".");
+					return HashBlock(buffer, dataSize, blockFrom);
+				});
+				futures.emplace_back(tasks.back().get_future());
+				group.workers->Submit(tasks, m_workerQueue);
+			}
+		}
+		else
+		{
+			const size_t readBytes = group.dataProvider->Read(readFrom, bytesToRead);
+
+			if (readBytes == 0)
+				break;
+
+			// @note Last block of the file may be shorter than block size, but it still must be hashed.
+			const size_t numOfBlocks = (readBytes + m_bytesToRead - 1) / m_bytesToRead;
+			const std::uint8_t * data = group.dataProvider->Data();
+			for (size_t i = 0; i < numOfBlocks; ++i)
+			{
+				const std::uint8_t * blockData = data + m_bytesToRead * i;
+				const size_t dataSize = std::min(m_bytesToRead, readBytes - m_bytesToRead * i);
+				tasks.emplace_back([this, blockData, dataSize, blockFrom = readFrom + m_bytesToRead * i]()
+				{
+					return HashBlock(blockData, dataSize, blockFrom);
+				});
+				futures.emplace_back(tasks.back().get_future());
+			}
+			group.workers->Submit(tasks, m_workerQueue);
+		}
+		pendingWindows.emplace_back(std::move(futures));
+
+		// @note Buffer of the provider is reused by the next read, so window must be completely hashed first.
+		if (pendingWindows.size() >= windowsInFlight)
+		{
+			if (!DeliverWindow(group, pendingWindows.front()))
+				break;
+			pendingWindows.pop_front();
+		}
+	}
+
+	for (; !pendingWindows.empty() && !m_stopExecution; pendingWindows.pop_front())
+		if (!DeliverWindow(group, pendingWindows.front()))
+			break;
+}
+
+void CalculatorManager::ReadPooled(WorkerGroup & group, size_t groupIndex, IPositionalDataProvider & provider)
+{
+	const bool streaming = m_totalSize == IDataProvider::UNKNOWN_SIZE;
+	const size_t bytesToRead = m_bytesToRead * m_blocksPerRead;
+	const size_t step = bytesToRead * m_groups.size();
+
+	BlockBufferPool & buffers = *group.buffers;
+	std::vector<WorkerPool::Task> tasks;
+	std::deque<std::vector<std::future<std::string>>> pendingWindows;
+
+	bool endOfData = false;
+	for (size_t readFrom = m_firstBlock * m_bytesToRead + bytesToRead * groupIndex; !endOfData && (streaming || readFrom < m_totalSize) && !m_stopExecution; readFrom += step)
+	{
+		const size_t windowEnd = streaming ? readFrom + bytesToRead : std::min(readFrom + bytesToRead, m_totalSize);
+
+		std::vector<std::future<std::string>> futures;
+		futures.reserve(m_blocksPerRead);
+		for (size_t blockFrom = readFrom; blockFrom < windowEnd && !endOfData; blockFrom += m_bytesToRead)
+		{
+			// @note Waits here while all buffers are being hashed, so reader never runs away from workers.
+			std::uint8_t * buffer = buffers.Acquire();
+			const size_t blockSize = std::min(m_bytesToRead, windowEnd - blockFrom);
+			size_t readBytes = 0;
+			try
+			{
+				readBytes = provider.ReadAt(blockFrom, blockSize, buffer);
+			}
+			catch (...)
+			{
+				buffers.Release(buffer);
+				throw;
+			}
+
+			// @note Only the last block of the stream may be shorter than block size.
+			endOfData = readBytes < blockSize;
+			if (readBytes == 0)
+			{
+				buffers.Release(buffer);
+				break;
+			}
+
+			// @note Block is hashed as soon as it is filled, without waiting for the rest of the window.
+			tasks.emplace_back([this, &buffers, buffer, readBytes, blockFrom]()
+			{
+				const BufferRelease release {buffers, buffer};
+				return HashBlock(buffer, readBytes, blockFrom);
+			});
+			futures.emplace_back(tasks.back().get_future());
+			group.workers->Submit(tasks, m_workerQueue);
+		}
+
+		if (!futures.empty())
+			pendingWindows.emplace_back(std::move(futures));
+
+		if (pendingWindows.size() >= 2)
+		{
+			if (!DeliverWindow(group, pendingWindows.front()))
+				return;
+			pendingWindows.pop_front();
+		}
+	}
+
+	for (; !pendingWindows.empty() && !m_stopExecution; pendingWindows.pop_front())
+		if (!DeliverWindow(group, pendingWindows.front()))
+			return;
+}
+
+std::string CalculatorManager::HashBlock(const std::uint8_t * data, size_t size, size_t blockOffset) const
+{
+	std::string hash = m_hashCalculator->CalculateHash(data, size);
+	if (!m_positionalSaver)
+		return hash;
+
+	m_positionalSaver->SaveAt(blockOffset / m_bytesToRead, hash);
+	return std::string();
+}
+
+bool CalculatorManager::DeliverWindow(WorkerGroup & group, std::vector<std::future<std::string>> & futures)
+{
+	std::vector<std::string> hashes;
+	hashes.reserve(futures.size());
+	for (std::future<std::string> & future : futures)
+		hashes.emplace_back(future.get());
+
+	std::unique_lock<std::mutex> lock(group.mutex);
+	group.conditionalVariable.wait(lock, [this, &group]() { return !group.readyWindow || m_stopExecution; });
+	if (m_stopExecution)
+		return false;
+	group.readyWindow = std::move(hashes);
+	group.conditionalVariable.notify_all();
+	return true;
+}
+
+} // namespace Calculator
@@ -0,0 +1,130 @@
+#ifndef SIGNATURE_CALCULATOR_H
+#define SIGNATURE_CALCULATOR_H
+
+#include <memory>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#include "Numa.h"
+
+class IHashSaver;
+class IPositionalHashSaver;
+class IDataProvider;
+class IPositionalDataProvider;
+
+namespace Hash { class IHashCalculator; }
+
+namespace Calculator
+{
+
+class WorkerPool;
+
+using DataProviderFactory = std::function<std::shared_ptr<IDataProvider>()>;
+
+struct CalculatorSettings
+{
+	/// @brief Number of hash workers. Zero means one worker per hardware thread.
+	unsigned int threads {0};
+	/// @brief Number of blocks queued for every worker by one provider read.
+	unsigned int queueDepth {1};
+	/// @brief Start one reader and one set of workers per NUMA node and pin them to the node CPUs.
+	/// @note Has effect only when manager is able to open one data provider per node.
+	bool numaAware {false};
+	/// @brief Nodes used by NUMA aware manager instead of detected ones, e.g. to run several groups on single node host.
+	/// @note Node with empty list of CPUs gets unpinned workers.
+	std::vector<NumaNode> numaNodes;
+	/// @brief Index of the first block to hash. Blocks before it are considered already saved.
+	size_t firstBlock {0};
+	/// @brief Index of the block after the last one to hash, zero means end of the source.
+	/// @note Together with firstBlock it selects shard of the file.
+	size_t endBlock {0};
+	/// @brief Called after hashes of all blocks before nextBlock have been passed to the saver.
+	/// @note Positional saver gets hashes in any order, but nextBlock still grows only when all blocks before it are written.
+	std::function<void(size_t nextBlock)> onCommitted;
+	/// @brief Upper bound of memory used for data blocks, zero means no limit.
+	/// @note Must be big enough to hold at least one block.
+	size_t memoryLimit {0};
+	/// @brief Already running hash workers shared with other jobs, manager starts its own ones if it is empty.
+	/// @note Shared workers are not pinned, so NUMA awareness is ignored.
+	std::shared_ptr<WorkerPool> workerPool;
+	/// @brief Queue of the shared workers used by the job, every job sharing workers needs its own one.
+	std::uint64_t workerQueue {0};
+};
+
+class CalculatorManager
+{
+public:
+	CalculatorManager(const std::shared_ptr<IDataProvider> & dataProvider,
+					  const std::shared_ptr<IHashSaver> & hashSaver,
+					  const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+					  const size_t readSize,
+					  const CalculatorSettings & settings = CalculatorSettings());
+
+	/// @param dataProviderFactory called once per worker group, so every NUMA node reads the file through its own provider.
+	CalculatorManager(const DataProviderFactory & dataProviderFactory,
+					  const std::shared_ptr<IHashSaver> & hashSaver,
+					  const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+					  const size_t readSize,
+					  const CalculatorSettings & settings = CalculatorSettings());
+
+	~CalculatorManager();
+	void Start();
+
+	/// @brief Returns end of the hashed data in the source, IDataProvider::UNKNOWN_SIZE for streams.
+	size_t TotalSize() const;
+
+private:
+	struct WorkerGroup;
+
+	enum class ReadMode
+	{
+		/// @brief Reader fills provider window, workers hash blocks inside of it.
+		window,
+		/// @brief Workers read their own blocks into their own buffers.
+		workers,
+		/// @brief Reader fills recycled buffers of bounded pool block by block.
+		pooled
+	};
+
+	CalculatorManager(const DataProviderFactory & dataProviderFactory,
+					  bool multipleProvidersAllowed,
+					  const std::shared_ptr<IHashSaver> & hashSaver,
+					  const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+					  const size_t readSize,
+					  const CalculatorSettings & settings);
+
+	void ReaderWorker(WorkerGroup & group, size_t groupIndex);
+	/// @brief Reads windows of the file assigned to the group.
+	void ReadWindows(WorkerGroup & group, size_t groupIndex);
+	/// @brief Reads sequential source block by block into recycled buffers of the group.
+	void ReadPooled(WorkerGroup & group, size_t groupIndex, IPositionalDataProvider & provider);
+	/// @brief Waits until window is hashed and hands its hashes to the saver.
+	/// @return false if execution was stopped.
+	bool DeliverWindow(WorkerGroup & group, std::vector<std::future<std::string>> & futures);
+	/// @brief Hashes the block. Positional saver gets hash right away and empty string is returned instead.
+	std::string HashBlock(const std::uint8_t * data, size_t size, size_t blockOffset) const;
+
+	const std::shared_ptr<IHashSaver> m_hashSaver;
+	/// @note Set if saver accepts hashes in any order, then workers write them and nothing is saved in Start().
+	const std::shared_ptr<IPositionalHashSaver> m_positionalSaver;
+	const std::shared_ptr<Hash::IHashCalculator> m_hashCalculator;
+	const size_t m_bytesToRead;
+	const size_t m_firstBlock;
+	const std::function<void(size_t)> m_onCommitted;
+	const std::uint64_t m_workerQueue;
+	size_t m_totalSize {0};
+	size_t m_blocksPerRead {1};
+	ReadMode m_readMode {ReadMode::window};
+
+	std::atomic_bool m_stopExecution {false};
+
+	/// @note Group i reads windows i, i + groups count, i + 2 * groups count and so on.
+	std::vector<std::unique_ptr<WorkerGroup>> m_groups;
+};
+} // namespace Calculator
+
+#endif
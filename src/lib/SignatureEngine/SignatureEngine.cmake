@@ -0,0 +1,53 @@
+# @note Static, so embedding applications get the whole engine without exporting its internals.
+add_library(SignatureEngine STATIC "${CMAKE_CURRENT_LIST_DIR}/SignatureEngine.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/SignatureEngine.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/SignatureCalculator.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/SignatureCalculator.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/DataProviderFactory.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/DataProviderFactory.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/MemoryDataProvider.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/MemoryDataProvider.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/BlockBufferPool.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/BlockBufferPool.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/Numa.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/Numa.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/WorkerPool.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/WorkerPool.cpp")
+target_include_directories(SignatureEngine INTERFACE "${CMAKE_CURRENT_LIST_DIR}")
+
+target_link_libraries(SignatureEngine InterfaceLib
+									  FileDataProvider
+									  MD5HashCalculator
+									  CRCHashCalculator
+									  Boost::filesystem)
+
+add_executable(engine_test_suite "${CMAKE_CURRENT_LIST_DIR}/unit_tests/engine_test.cpp")
+
+target_compile_definitions(engine_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=engine_test_suite)
+
+target_link_libraries(engine_test_suite Boost::unit_test_framework
+										SignatureEngine)
+
+add_test(NAME engine_test_runner COMMAND engine_test_suite)
+
+# @note End to end suites: differential compares every read method with plain reference,
+# throughput compares speed with baseline recorded for the build on the host. Label "e2e" selects both.
+add_executable(e2e_test_suite "${CMAKE_CURRENT_LIST_DIR}/e2e_tests/e2e_test.cpp")
+
+target_compile_definitions(e2e_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=e2e_test_suite
+												  E2E_BUILD_TYPE="$<CONFIG>"
+												  E2E_COMPILER="${CMAKE_CXX_COMPILER_ID}-${CMAKE_CXX_COMPILER_VERSION}"
+												  E2E_BASELINE_DIRECTORY="${CMAKE_BINARY_DIR}")
+
+target_link_libraries(e2e_test_suite Boost::unit_test_framework
+									 FileHashSaver
+									 SignatureEngine)
+
+add_test(NAME e2e_differential_runner COMMAND e2e_test_suite --run_test=differential)
+set_tests_properties(e2e_differential_runner PROPERTIES LABELS "e2e;differential")
+
+# @note Speed depends on the host and its load, so throughput is checked only in builds which ask for it.
+if (SIGNATURE_GENERATOR_THROUGHPUT_TESTS)
+	add_test(NAME e2e_throughput_runner COMMAND e2e_test_suite --run_test=throughput)
+	set_tests_properties(e2e_throughput_runner PROPERTIES LABELS "e2e;throughput" RUN_SERIAL TRUE)
+endif()
@@ -0,0 +1,218 @@
+#include "SignatureEngine.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "IDataProvider.h"
+#include "IHashSaver.h"
+
+#include "CRCHashCalculator.h"
+#include "MD5HashCalculator.h"
+#include "MemoryDataProvider.h"
+#include "SignatureCalculator.h"
+#include "WorkerPool.h"
+
+namespace Calculator
+{
+
+namespace
+{
+/// @note Hashing of the task without callback is paused when reader falls behind by this number of digests.
+constexpr size_t MAX_PENDING_DIGESTS = 65536;
+
+/// @note Thrown out of the saver to unwind hashing of cancelled task.
+struct TaskCancelled {};
+} // namespace
+
+class SignatureTask::TaskHashSaver : public IHashSaver
+{
+public:
+	explicit TaskHashSaver(SignatureTask & task)
+		: m_task(task)
+	{}
+
+	void Save(const std::string & hash) override { m_task.Deliver(hash); }
+	void Sync() override {}
+
+private:
+	SignatureTask & m_task;
+};
+
+SignatureTask::SignatureTask(const DataProviderFactory & dataProviderFactory,
+							 const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+							 size_t blockSize,
+							 const std::shared_ptr<WorkerPool> & workers,
+							 std::uint64_t workerQueue,
+							 const DigestCallback & onDigest)
+	: m_onDigest(onDigest)
+{
+	CalculatorSettings settings;
+	settings.workerPool = workers;
+	settings.workerQueue = workerQueue;
+	m_manager = std::make_unique<CalculatorManager>(dataProviderFactory, std::make_shared<TaskHashSaver>(*this), hashCalculator, blockSize, settings);
+
+	const size_t totalSize = m_manager->TotalSize();
+	m_totalBlocks = totalSize == IDataProvider::UNKNOWN_SIZE ? TaskProgress::UNKNOWN_BLOCKS : (totalSize + blockSize - 1) / blockSize;
+
+	m_thread = std::thread(&SignatureTask::Run, this);
+}
+
+SignatureTask::~SignatureTask()
+{
+	Cancel();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+bool SignatureTask::Next(std::string & digest)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_conditionalVariable.wait(lock, [this]() { return !m_digests.empty() || m_finished || m_cancelled; });
+	if (m_cancelled)
+		return false;
+
+	if (m_digests.empty())
+	{
+		if (m_error)
+			std::rethrow_exception(m_error);
+		return false;
+	}
+
+	digest = std::move(m_digests.front());
+	m_digests.pop_front();
+	lock.unlock();
+	m_conditionalVariable.notify_all();
+	return true;
+}
+
+void SignatureTask::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_conditionalVariable.wait(lock, [this]() { return m_finished; });
+	if (m_error)
+		std::rethrow_exception(m_error);
+}
+
+void SignatureTask::Cancel()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cancelled = true;
+	}
+	m_conditionalVariable.notify_all();
+}
+
+bool SignatureTask::Cancelled() const
+{
+	return m_cancelled;
+}
+
+bool SignatureTask::Finished() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_finished;
+}
+
+TaskProgress SignatureTask::Progress() const
+{
+	TaskProgress progress;
+	progress.hashedBlocks = m_hashedBlocks;
+	progress.totalBlocks = m_totalBlocks;
+	return progress;
+}
+
+void SignatureTask::Run()
+{
+	std::exception_ptr error;
+	try
+	{
+		m_manager->Start();
+	}
+	catch (const TaskCancelled &)
+	{
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_cancelled)
+			m_error = error;
+		m_finished = true;
+	}
+	m_conditionalVariable.notify_all();
+}
+
+void SignatureTask::Deliver(const std::string & digest)
+{
+	if (m_cancelled)
+		throw TaskCancelled();
+
+	if (m_onDigest)
+	{
+		m_onDigest(m_hashedBlocks, digest);
+		++m_hashedBlocks;
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_conditionalVariable.wait(lock, [this]() { return m_digests.size() < MAX_PENDING_DIGESTS || m_cancelled; });
+		if (m_cancelled)
+			throw TaskCancelled();
+		m_digests.push_back(digest);
+		++m_hashedBlocks;
+	}
+	m_conditionalVariable.notify_all();
+}
+
+SignatureEngine::SignatureEngine(unsigned int threads)
+	: m_workers(std::make_shared<WorkerPool>(threads > 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u)))
+{
+}
+
+SignatureEngine::~SignatureEngine() = default;
+
+unsigned int SignatureEngine::Threads() const
+{
+	return m_workers->Size();
+}
+
+std::unique_ptr<SignatureTask> SignatureEngine::SubmitFile(const std::string & filePath,
+														   size_t blockSize,
+														   const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+														   const DigestCallback & onDigest,
+														   ProviderType providerType)
+{
+	const DataProviderFactory dataProviderFactory = [filePath, providerType]()
+	{
+		return CreateDataProvider(providerType, filePath);
+	};
+	return std::unique_ptr<SignatureTask>(new SignatureTask(dataProviderFactory, hashCalculator, blockSize, m_workers, m_nextQueue++, onDigest));
+}
+
+std::unique_ptr<SignatureTask> SignatureEngine::SubmitBuffer(const std::uint8_t * data,
+															 size_t size,
+															 size_t blockSize,
+															 const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+															 const DigestCallback & onDigest)
+{
+	const DataProviderFactory dataProviderFactory = [data, size]()
+	{
+		return std::make_shared<MemoryDataProvider>(data, size);
+	};
+	return std::unique_ptr<SignatureTask>(new SignatureTask(dataProviderFactory, hashCalculator, blockSize, m_workers, m_nextQueue++, onDigest));
+}
+
+std::shared_ptr<Hash::IHashCalculator> CreateHashCalculator(const std::string & algorithm)
+{
+	if (algorithm == "md5")
+		return std::make_shared<Hash::MD5Hash>();
+	if (algorithm == "crc")
+		return std::make_shared<Hash::CRCHash>();
+	throw std::invalid_argument("Unknown algorithm: " + algorithm);
+}
+
+} // namespace Calculator
@@ -0,0 +1,128 @@
+#ifndef SIGNATURE_ENGINE_H
+#define SIGNATURE_ENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "DataProviderFactory.h"
+#include "SignatureCalculator.h"
+
+namespace Hash { class IHashCalculator; }
+
+namespace Calculator
+{
+
+/// @brief Receives digest of every block in block order.
+using DigestCallback = std::function<void(std::uint64_t block, const std::string & digest)>;
+
+struct TaskProgress
+{
+	static constexpr std::uint64_t UNKNOWN_BLOCKS = static_cast<std::uint64_t>(-1);
+
+	std::uint64_t hashedBlocks {0};
+	/// @note UNKNOWN_BLOCKS for streams.
+	std::uint64_t totalBlocks {0};
+};
+
+/// @brief Signature of one source computed in background.
+/// Digests are passed to the callback if it is given, otherwise they are read one by one with Next().
+class SignatureTask
+{
+public:
+	~SignatureTask();
+
+	SignatureTask(const SignatureTask &) = delete;
+	SignatureTask & operator=(const SignatureTask &) = delete;
+
+	/// @brief Waits for digest of the next block.
+	/// @return false after the last block or if task is cancelled.
+	/// @note Throws exception the task failed with. Hashing waits while too many digests are not read.
+	bool Next(std::string & digest);
+	/// @brief Waits until task is completed or cancelled.
+	/// @note Throws exception the task failed with. Task without callback must be read with Next() instead.
+	void Wait();
+	/// @brief Stops hashing, blocks which are not hashed yet are skipped.
+	void Cancel();
+
+	bool Cancelled() const;
+	bool Finished() const;
+	TaskProgress Progress() const;
+
+private:
+	friend class SignatureEngine;
+	class TaskHashSaver;
+
+	SignatureTask(const DataProviderFactory & dataProviderFactory,
+				  const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+				  size_t blockSize,
+				  const std::shared_ptr<WorkerPool> & workers,
+				  std::uint64_t workerQueue,
+				  const DigestCallback & onDigest);
+
+	void Run();
+	void Deliver(const std::string & digest);
+
+	const DigestCallback m_onDigest;
+	std::unique_ptr<CalculatorManager> m_manager;
+	std::uint64_t m_totalBlocks {0};
+
+	std::atomic_bool m_cancelled {false};
+	std::atomic<std::uint64_t> m_hashedBlocks {0};
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_conditionalVariable;
+	std::deque<std::string> m_digests;
+	bool m_finished {false};
+	std::exception_ptr m_error;
+
+	/// @note Started last, when everything it uses is constructed.
+	std::thread m_thread;
+};
+
+/// @brief Entry point of embedding applications.
+/// All tasks of the engine are hashed by one set of workers, which serves tasks in turn.
+class SignatureEngine
+{
+public:
+	/// @param threads number of hash workers, zero means one worker per hardware thread.
+	explicit SignatureEngine(unsigned int threads = 0);
+	~SignatureEngine();
+
+	SignatureEngine(const SignatureEngine &) = delete;
+	SignatureEngine & operator=(const SignatureEngine &) = delete;
+
+	unsigned int Threads() const;
+
+	/// @note Throws exception if file cannot be opened.
+	std::unique_ptr<SignatureTask> SubmitFile(const std::string & filePath,
+											  size_t blockSize,
+											  const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+											  const DigestCallback & onDigest = DigestCallback(),
+											  ProviderType providerType = AvailableProviderTypes().front());
+
+	/// @note Buffer is hashed in place, it must stay valid and unchanged until task is finished.
+	std::unique_ptr<SignatureTask> SubmitBuffer(const std::uint8_t * data,
+												size_t size,
+												size_t blockSize,
+												const std::shared_ptr<Hash::IHashCalculator> & hashCalculator,
+												const DigestCallback & onDigest = DigestCallback());
+
+private:
+	std::shared_ptr<WorkerPool> m_workers;
+	std::atomic<std::uint64_t> m_nextQueue {1};
+};
+
+/// @brief Creates calculator by algorithm name ("md5" or "crc").
+/// @note Throws exception for unknown algorithm.
+std::shared_ptr<Hash::IHashCalculator> CreateHashCalculator(const std::string & algorithm);
+
+} // namespace Calculator
+
+#endif
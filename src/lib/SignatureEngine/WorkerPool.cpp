@@ -0,0 +1,114 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+#include "Numa.h"
+
+namespace Calculator
+{
+
+WorkerPool::WorkerPool(unsigned int threads, const std::vector<int> & cpus)
+	: m_cpus(cpus)
+{
+	if (threads < 1)
+		throw std::invalid_argument("Invalid number of threads.");
+
+	for (unsigned int i = 0; i < threads; ++i)
+		m_threadsPool.emplace_back(&WorkerPool::ThreadWorker, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+		m_stopExecution = true;
+	}
+	m_tasksConditionalVariable.notify_all();
+
+	for (std::thread & thread : m_threadsPool)
+	{
+		if (thread.joinable())
+			thread.join();
+	}
+}
+
+unsigned int WorkerPool::Size() const
+{
+	return static_cast<unsigned int>(m_threadsPool.size());
+}
+
+void WorkerPool::Submit(std::vector<Task> & tasks, QueueId queue)
+{
+	if (tasks.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+		Queue & target = m_queues[queue];
+		if (target.tasks.empty())
+			m_readyQueues.push_back(queue);
+		for (Task & task : tasks)
+			target.tasks.emplace_back(std::move(task));
+	}
+	tasks.clear();
+	m_tasksConditionalVariable.notify_all();
+}
+
+void WorkerPool::CancelQueue(QueueId queue)
+{
+	std::deque<Task> dropped;
+	{
+		std::unique_lock<std::mutex> lock(m_tasksMutex);
+		const auto it = m_queues.find(queue);
+		if (it == m_queues.end())
+			return;
+
+		dropped.swap(it->second.tasks);
+		m_readyQueues.erase(std::remove(m_readyQueues.begin(), m_readyQueues.end(), queue), m_readyQueues.end());
+		if (it->second.running == 0)
+			m_queues.erase(it);
+		else
+			m_idleConditionalVariable.wait(lock, [this, queue]() { return m_queues.count(queue) == 0; });
+	}
+	// @note Dropped tasks are destroyed outside of the lock, their futures become ready with broken promise.
+}
+
+void WorkerPool::ThreadWorker()
+{
+	PinCurrentThread(m_cpus);
+
+	while (true)
+	{
+		Task task;
+		QueueId queue = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_tasksMutex);
+			m_tasksConditionalVariable.wait(lock, [this]() { return m_stopExecution || !m_readyQueues.empty(); });
+
+			if (m_stopExecution)
+				break;
+
+			queue = m_readyQueues.front();
+			m_readyQueues.pop_front();
+			Queue & source = m_queues[queue];
+			task = std::move(source.tasks.front());
+			source.tasks.pop_front();
+			++source.running;
+			// @note Queue goes to the end of the line, so the next task is taken from another job.
+			if (!source.tasks.empty())
+				m_readyQueues.push_back(queue);
+		}
+
+		task();
+
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+		const auto it = m_queues.find(queue);
+		if (--it->second.running == 0 && it->second.tasks.empty())
+		{
+			m_queues.erase(it);
+			m_idleConditionalVariable.notify_all();
+		}
+	}
+}
+
+} // namespace Calculator
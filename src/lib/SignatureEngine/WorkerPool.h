@@ -0,0 +1,64 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Calculator
+{
+
+/// @brief Fixed set of threads executing hash tasks.
+/// Tasks of one queue are executed in submission order, non-empty queues are served in turn one task at a time,
+/// so jobs sharing the pool progress fairly.
+class WorkerPool
+{
+public:
+	using Task = std::packaged_task<std::string()>;
+	using QueueId = std::uint64_t;
+
+	/// @param cpus if not empty, every worker is pinned to this CPU set.
+	WorkerPool(unsigned int threads, const std::vector<int> & cpus = {});
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool & operator=(const WorkerPool &) = delete;
+
+	unsigned int Size() const;
+	/// @brief Queues all tasks under one lock and wakes workers up.
+	void Submit(std::vector<Task> & tasks, QueueId queue = 0);
+	/// @brief Drops tasks of the queue which are not started yet and waits until the started ones are finished.
+	/// @note Futures of dropped tasks report broken promise.
+	void CancelQueue(QueueId queue);
+
+private:
+	struct Queue
+	{
+		std::deque<Task> tasks;
+		size_t running {0};
+	};
+
+	void ThreadWorker();
+
+	const std::vector<int> m_cpus;
+	bool m_stopExecution {false};
+
+	std::vector<std::thread> m_threadsPool;
+	std::mutex m_tasksMutex;
+	std::condition_variable m_tasksConditionalVariable;
+	std::condition_variable m_idleConditionalVariable;
+	/// @note Queue is removed as soon as it has neither queued nor running tasks.
+	std::unordered_map<QueueId, Queue> m_queues;
+	/// @note Queues which have tasks to start, in order of service.
+	std::deque<QueueId> m_readyQueues;
+};
+
+} // namespace Calculator
+
+#endif
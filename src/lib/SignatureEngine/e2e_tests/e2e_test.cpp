@@ -0,0 +1,691 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "IDataProvider.h"
+#include "IHashCalculator.h"
+#include "IHashSaver.h"
+
+#include "DataProviderFactory.h"
+#include "PositionalHashSaver.h"
+#include "SignatureCalculator.h"
+#include "SignatureEngine.h"
+#include "WorkerPool.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// @note End to end tests run every way of reading and hashing the file and compare result with plain single threaded
+// reference. Sizes of generated inputs are multiplied by SIGNATURE_GENERATOR_E2E_SCALE (default 1).
+
+namespace
+{
+constexpr size_t MEGABYTE = 1048576;
+/// @note Measured throughput lower than baseline by this share is reported as regression.
+constexpr double DEFAULT_REGRESSION_THRESHOLD = 0.25;
+constexpr size_t THROUGHPUT_FILE_SIZE = 64 * MEGABYTE;
+constexpr size_t THROUGHPUT_BLOCK_SIZE = MEGABYTE;
+constexpr int THROUGHPUT_RUNS = 3;
+
+const std::vector<std::string> ALGORITHMS = {"md5", "crc"};
+
+class VectorHashSaver : public IHashSaver
+{
+public:
+	void Save(const std::string & hash) override { hashes.push_back(hash); }
+	void Sync() override {}
+
+	std::vector<std::string> hashes;
+};
+
+/// @brief Remembers which threads hashed blocks and how many blocks were hashed at once.
+class ThreadRecordingHashCalculator : public Hash::IHashCalculator
+{
+public:
+	explicit ThreadRecordingHashCalculator(const std::shared_ptr<Hash::IHashCalculator> & hashCalculator)
+		: m_hashCalculator(hashCalculator)
+	{}
+
+	std::string CalculateHash(const std::vector<std::uint8_t> & data) override
+	{
+		return CalculateHash(data.data(), data.size());
+	}
+
+	std::string CalculateHash(const std::uint8_t * data, size_t size) override
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_threads.insert(std::this_thread::get_id());
+			m_maxRunning = std::max(m_maxRunning, ++m_running);
+		}
+		// @note Slow hashing lets other workers take blocks even on single core host.
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		std::string hash = m_hashCalculator->CalculateHash(data, size);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		--m_running;
+		return hash;
+	}
+
+	size_t Threads() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_threads.size();
+	}
+
+	size_t MaxRunning() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_maxRunning;
+	}
+
+private:
+	const std::shared_ptr<Hash::IHashCalculator> m_hashCalculator;
+	mutable std::mutex m_mutex;
+	std::set<std::thread::id> m_threads;
+	size_t m_running {0};
+	size_t m_maxRunning {0};
+};
+
+size_t Scale()
+{
+	const char * scale = std::getenv("SIGNATURE_GENERATOR_E2E_SCALE");
+	return scale ? std::max<size_t>(std::strtoull(scale, nullptr, 10), 1) : 1;
+}
+
+std::string HostName()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	char name[256] = {};
+	if (gethostname(name, sizeof(name) - 1) == 0 && name[0] != '\0')
+		return name;
+#endif
+	return "localhost";
+}
+
+/// @brief Generated inputs, removed when tests are finished.
+class Inputs
+{
+public:
+	Inputs()
+		: m_directory(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("signature-e2e-%%%%-%%%%"))
+	{
+		boost::filesystem::create_directories(m_directory);
+		const size_t scale = Scale();
+
+		std::mt19937_64 generator(42);
+		WriteFile("random", 6 * MEGABYTE * scale + 12345, [&generator]() { return static_cast<char>(generator()); });
+		WriteFile("zero", 4 * MEGABYTE * scale, []() { return '\0'; });
+		WriteFile("exact", MEGABYTE * scale, [&generator]() { return static_cast<char>(generator()); });
+		WriteFile("single_byte", 1, []() { return 'x'; });
+		WriteFile("empty", 0, []() { return '\0'; });
+
+		// @note Holes are read as zeros, but providers see them differently than written zeros.
+		const std::string sparse = Path("sparse");
+		{
+			std::ofstream file(sparse, std::ios_base::binary);
+			for (const size_t offset : {size_t(0), 5 * MEGABYTE * scale + 777, 11 * MEGABYTE * scale + 1})
+			{
+				file.seekp(static_cast<std::streamoff>(offset));
+				for (size_t i = 0; i < 10000; ++i)
+					file.put(static_cast<char>(generator()));
+			}
+		}
+		boost::filesystem::resize_file(sparse, 16 * MEGABYTE * scale + 3);
+		m_files.push_back("sparse");
+	}
+
+	~Inputs()
+	{
+		boost::system::error_code error;
+		boost::filesystem::remove_all(m_directory, error);
+	}
+
+	std::string Path(const std::string & name) const
+	{
+		return (m_directory / name).string();
+	}
+
+	const std::vector<std::string> & Names() const
+	{
+		return m_files;
+	}
+
+private:
+	template <typename Generator>
+	void WriteFile(const std::string & name, size_t size, Generator generate)
+	{
+		std::vector<char> data(size);
+		std::generate(data.begin(), data.end(), generate);
+		std::ofstream(Path(name), std::ios_base::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+		m_files.push_back(name);
+	}
+
+	const boost::filesystem::path m_directory;
+	std::vector<std::string> m_files;
+};
+
+const Inputs & GeneratedInputs()
+{
+	static const Inputs inputs;
+	return inputs;
+}
+
+/// @brief Plain single threaded reading and hashing block by block.
+std::vector<std::string> Reference(const std::string & path, size_t blockSize, Hash::IHashCalculator & hasher, size_t firstBlock = 0, size_t endBlock = 0)
+{
+	std::ifstream file(path, std::ios_base::binary);
+	file.seekg(static_cast<std::streamoff>(firstBlock * blockSize));
+	std::vector<std::uint8_t> block(blockSize);
+	std::vector<std::string> hashes;
+	for (size_t index = firstBlock; endBlock == 0 || index < endBlock; ++index)
+	{
+		file.read(reinterpret_cast<char *>(block.data()), static_cast<std::streamsize>(blockSize));
+		const size_t size = static_cast<size_t>(file.gcount());
+		if (size == 0)
+			break;
+		hashes.push_back(hasher.CalculateHash(block.data(), size));
+	}
+	return hashes;
+}
+
+std::vector<std::string> Calculate(const Calculator::DataProviderFactory & factory, size_t blockSize, const std::shared_ptr<Hash::IHashCalculator> & hashCalculator, const Calculator::CalculatorSettings & settings)
+{
+	const auto saver = std::make_shared<VectorHashSaver>();
+	Calculator::CalculatorManager manager(factory, saver, hashCalculator, blockSize, settings);
+	manager.Start();
+	return saver->hashes;
+}
+
+std::vector<std::string> Calculate(const Calculator::DataProviderFactory & factory, size_t blockSize, const std::string & algorithm, const Calculator::CalculatorSettings & settings)
+{
+	return Calculate(factory, blockSize, Calculator::CreateHashCalculator(algorithm), settings);
+}
+
+/// @brief Provider types and cache policies to run, direct I/O is skipped if file system does not support it.
+std::vector<std::pair<Calculator::ProviderType, CachePolicy>> ReadMethods(const std::string & path)
+{
+	std::vector<std::pair<Calculator::ProviderType, CachePolicy>> methods;
+	for (const Calculator::ProviderType type : Calculator::AvailableProviderTypes())
+	{
+		methods.emplace_back(type, CachePolicy::keep);
+		methods.emplace_back(type, CachePolicy::drop);
+	}
+	try
+	{
+		Calculator::CreateDataProvider(Calculator::AvailableProviderTypes().front(), path, CachePolicy::bypass);
+		methods.emplace_back(Calculator::AvailableProviderTypes().front(), CachePolicy::bypass);
+	}
+	catch (const std::exception & ex)
+	{
+		BOOST_TEST_MESSAGE("Direct I/O is skipped: " << ex.what());
+	}
+	return methods;
+}
+
+/// @brief Build type and compiler, throughput of one build is not compared with baseline of another one.
+std::string BuildName()
+{
+#if defined(E2E_BUILD_TYPE) && defined(E2E_COMPILER)
+	const std::string buildType = E2E_BUILD_TYPE;
+	return (buildType.empty() ? "NoConfig" : buildType) + "-" + E2E_COMPILER;
+#else
+	// @note Build without CMake definitions is told apart by assertions and compiler version only.
+	#if defined(NDEBUG)
+	const std::string buildType = "Release";
+	#else
+	const std::string buildType = "Debug";
+	#endif
+	#if defined(__VERSION__)
+	return buildType + "-" + __VERSION__;
+	#else
+	return buildType;
+	#endif
+#endif
+}
+
+/// @note Baseline is kept in the build tree, not in home directory shared by all builds of the host.
+std::string BaselinePath()
+{
+	if (const char * path = std::getenv("SIGNATURE_GENERATOR_BASELINE"); path != nullptr && path[0] != '\0')
+		return path;
+
+#if defined(E2E_BASELINE_DIRECTORY)
+	const boost::filesystem::path directory = E2E_BASELINE_DIRECTORY;
+#else
+	const boost::filesystem::path directory = boost::filesystem::current_path();
+#endif
+	return (directory / (HostName() + ".baseline")).string();
+}
+
+std::map<std::string, double> LoadBaseline(const std::string & path)
+{
+	std::map<std::string, double> baseline;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const size_t separator = line.find('=');
+		if (separator != std::string::npos)
+			baseline[line.substr(0, separator)] = std::stod(line.substr(separator + 1));
+	}
+	return baseline;
+}
+
+void SaveBaseline(const std::string & path, const std::map<std::string, double> & baseline)
+{
+	boost::system::error_code error;
+	boost::filesystem::create_directories(boost::filesystem::path(path).parent_path(), error);
+	std::ofstream file(path, std::ios_base::trunc);
+	for (const auto & [key, value] : baseline)
+		file << key << '=' << value << '\n';
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(differential)
+
+BOOST_AUTO_TEST_CASE(every_read_method_matches_reference)
+{
+	const Inputs & inputs = GeneratedInputs();
+	const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+
+	// @note Block sizes which are not multiple of page size make windows start at unaligned offsets.
+	for (const size_t blockSize : {size_t(4096), size_t(1000), size_t(65537)})
+	{
+		for (const std::string & name : inputs.Names())
+		{
+			const std::string path = inputs.Path(name);
+			for (const std::string & algorithm : ALGORITHMS)
+			{
+				const std::vector<std::string> reference = Reference(path, blockSize, *Calculator::CreateHashCalculator(algorithm));
+				for (const auto & [type, cachePolicy] : ReadMethods(path))
+				{
+					for (const unsigned int threads : {1u, 3u, hardwareThreads})
+					{
+						for (const size_t memoryLimit : {size_t(0), 2 * blockSize})
+						{
+							std::ostringstream description;
+							description << name << " block " << blockSize << ' ' << algorithm << ' ' << Calculator::ToString(type)
+										<< " cache " << Calculator::ToString(cachePolicy) << " threads " << threads << " memory " << memoryLimit;
+
+							Calculator::CalculatorSettings settings;
+							settings.threads = threads;
+							settings.queueDepth = threads == 1 ? 1 : 4;
+							settings.memoryLimit = memoryLimit;
+							const Calculator::DataProviderFactory factory = [type = type, cachePolicy = cachePolicy, &path]()
+							{
+								return Calculator::CreateDataProvider(type, path, cachePolicy);
+							};
+
+							try
+							{
+								BOOST_CHECK_MESSAGE(Calculate(factory, blockSize, algorithm, settings) == reference, description.str());
+							}
+							catch (const std::exception & ex)
+							{
+								BOOST_ERROR(description.str() << " failed: " << ex.what());
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(block_range_matches_reference)
+{
+	const Inputs & inputs = GeneratedInputs();
+	const std::string path = inputs.Path("random");
+	constexpr size_t BLOCK_SIZE = 4097;
+	const size_t totalBlocks = (boost::filesystem::file_size(path) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	// @note Resumed job starts in the middle of the file, shard also ends before its end.
+	for (const auto & [firstBlock, endBlock] : {std::make_pair<size_t, size_t>(3, 0), std::make_pair<size_t, size_t>(17, 1001), std::make_pair(totalBlocks - 1, totalBlocks + 5)})
+	{
+		const std::vector<std::string> reference = Reference(path, BLOCK_SIZE, *Calculator::CreateHashCalculator("md5"), firstBlock, endBlock);
+		for (const auto & [type, cachePolicy] : ReadMethods(path))
+		{
+			Calculator::CalculatorSettings settings;
+			settings.threads = 3;
+			settings.firstBlock = firstBlock;
+			settings.endBlock = endBlock;
+			const Calculator::DataProviderFactory factory = [type = type, cachePolicy = cachePolicy, &path]()
+			{
+				return Calculator::CreateDataProvider(type, path, cachePolicy);
+			};
+			BOOST_CHECK_MESSAGE(Calculate(factory, BLOCK_SIZE, "md5", settings) == reference,
+								Calculator::ToString(type) << " blocks from " << firstBlock << " to " << endBlock);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(positional_output_matches_reference)
+{
+	const Inputs & inputs = GeneratedInputs();
+	const std::string output = inputs.Path("positional_output");
+
+	for (const std::string & name : inputs.Names())
+	{
+		const std::string path = inputs.Path(name);
+		for (const std::string & algorithm : ALGORITHMS)
+		{
+			std::string reference;
+			for (const std::string & hash : Reference(path, 1000, *Calculator::CreateHashCalculator(algorithm)))
+				reference += hash;
+
+			for (const auto & [type, cachePolicy] : ReadMethods(path))
+			{
+				for (const unsigned int threads : {1u, 3u})
+				{
+					Calculator::CalculatorSettings settings;
+					settings.threads = threads;
+					settings.queueDepth = 4;
+					const Calculator::DataProviderFactory factory = [type = type, cachePolicy = cachePolicy, &path]()
+					{
+						return Calculator::CreateDataProvider(type, path, cachePolicy);
+					};
+					{
+						const auto saver = std::make_shared<PositionalHashSaver>(output, algorithm == "md5" ? 32 : 8);
+						Calculator::CalculatorManager manager(factory, saver, Calculator::CreateHashCalculator(algorithm), 1000, settings);
+						manager.Start();
+						saver->Sync();
+					}
+
+					std::ifstream file(output, std::ios_base::binary);
+					const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+					BOOST_CHECK_MESSAGE(content == reference, "positional " << name << ' ' << algorithm << ' ' << Calculator::ToString(type)
+										<< " cache " << Calculator::ToString(cachePolicy) << " threads " << threads);
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(memory_limit_holds_with_shared_workers)
+{
+	const std::string path = GeneratedInputs().Path("exact");
+	constexpr size_t blockSize = 16384;
+	const std::vector<std::string> reference = Reference(path, blockSize, *Calculator::CreateHashCalculator("md5"));
+	const auto workers = std::make_shared<Calculator::WorkerPool>(6);
+
+	for (const Calculator::ProviderType type : Calculator::AvailableProviderTypes())
+	{
+		for (const size_t memoryLimit : {size_t(0), 2 * blockSize})
+		{
+			Calculator::CalculatorSettings settings;
+			settings.workerPool = workers;
+			settings.workerQueue = 1;
+			settings.memoryLimit = memoryLimit;
+			const Calculator::DataProviderFactory factory = [type, &path]()
+			{
+				return Calculator::CreateDataProvider(type, path);
+			};
+			const auto hashCalculator = std::make_shared<ThreadRecordingHashCalculator>(Calculator::CreateHashCalculator("md5"));
+			const std::string description = Calculator::ToString(type) + " memory " + std::to_string(memoryLimit);
+
+			BOOST_CHECK_MESSAGE(Calculate(factory, blockSize, hashCalculator, settings) == reference, description);
+			// @note Every block being hashed holds a buffer, so no more blocks than the limit allows are hashed at once.
+			if (memoryLimit > 0)
+				BOOST_CHECK_MESSAGE(hashCalculator->MaxRunning() <= 2, description << " hashed " << hashCalculator->MaxRunning() << " blocks at once");
+			else
+				BOOST_CHECK_MESSAGE(hashCalculator->MaxRunning() > 2, description << " hashed " << hashCalculator->MaxRunning() << " blocks at once");
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(numa_groups_match_reference)
+{
+	const Inputs & inputs = GeneratedInputs();
+	// @note Synthetic nodes without CPUs give unpinned groups, so several groups are run on any host.
+	std::vector<Calculator::NumaNode> nodes(3);
+	for (size_t i = 0; i < nodes.size(); ++i)
+		nodes[i].id = static_cast<int>(i);
+
+	for (const size_t blockSize : {size_t(4096), size_t(1000)})
+	{
+		for (const std::string & name : inputs.Names())
+		{
+			const std::string path = inputs.Path(name);
+			for (const std::string & algorithm : ALGORITHMS)
+			{
+				const std::vector<std::string> reference = Reference(path, blockSize, *Calculator::CreateHashCalculator(algorithm));
+				for (const auto & [type, cachePolicy] : ReadMethods(path))
+				{
+					for (const size_t groups : {size_t(2), size_t(3)})
+					{
+						std::ostringstream description;
+						description << name << " block " << blockSize << ' ' << algorithm << ' ' << Calculator::ToString(type)
+									<< " cache " << Calculator::ToString(cachePolicy) << " groups " << groups;
+
+						Calculator::CalculatorSettings settings;
+						settings.threads = 4;
+						settings.queueDepth = 2;
+						settings.numaAware = true;
+						settings.numaNodes.assign(nodes.begin(), nodes.begin() + static_cast<std::ptrdiff_t>(groups));
+						size_t providers = 0;
+						const Calculator::DataProviderFactory factory = [type = type, cachePolicy = cachePolicy, &path, &providers]()
+						{
+							++providers;
+							return Calculator::CreateDataProvider(type, path, cachePolicy);
+						};
+
+						try
+						{
+							BOOST_CHECK_MESSAGE(Calculate(factory, blockSize, algorithm, settings) == reference, description.str());
+							// @note Every group reads its part of the file through its own provider.
+							BOOST_CHECK_MESSAGE(providers == groups, description.str() << " opened " << providers << " providers");
+						}
+						catch (const std::exception & ex)
+						{
+							BOOST_ERROR(description.str() << " failed: " << ex.what());
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(memory_limit_leaves_fewer_numa_groups)
+{
+	const std::string path = GeneratedInputs().Path("exact");
+	constexpr size_t blockSize = 16384;
+	const std::vector<std::string> reference = Reference(path, blockSize, *Calculator::CreateHashCalculator("md5"));
+	const std::vector<Calculator::NumaNode> nodes(3);
+
+	for (const auto & [type, cachePolicy] : ReadMethods(path))
+	{
+		// @note Every group holds at least one block, so limit of fewer blocks than nodes leaves one group per block.
+		// Single group is not pinned, just like on single node host.
+		for (const size_t blocks : {size_t(1), size_t(2), size_t(3), size_t(6)})
+		{
+			const std::string description = Calculator::ToString(type) + " cache " + Calculator::ToString(cachePolicy) + " blocks " + std::to_string(blocks);
+			Calculator::CalculatorSettings settings;
+			settings.threads = 6;
+			settings.memoryLimit = blocks * blockSize;
+			settings.numaAware = true;
+			settings.numaNodes = nodes;
+			size_t providers = 0;
+			const Calculator::DataProviderFactory factory = [type = type, cachePolicy = cachePolicy, &path, &providers]()
+			{
+				++providers;
+				return Calculator::CreateDataProvider(type, path, cachePolicy);
+			};
+			const auto hashCalculator = std::make_shared<ThreadRecordingHashCalculator>(Calculator::CreateHashCalculator("md5"));
+
+			BOOST_CHECK_MESSAGE(Calculate(factory, blockSize, hashCalculator, settings) == reference, description);
+			BOOST_CHECK_MESSAGE(providers == std::min(blocks, nodes.size()), description << " opened " << providers << " providers");
+			BOOST_CHECK_MESSAGE(hashCalculator->MaxRunning() <= blocks, description << " hashed " << hashCalculator->MaxRunning() << " blocks at once");
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(buffer_source_matches_reference)
+{
+	const Inputs & inputs = GeneratedInputs();
+	const std::string path = inputs.Path("random");
+	std::ifstream file(path, std::ios_base::binary);
+	const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	Calculator::SignatureEngine engine(3);
+	for (const std::string & algorithm : ALGORITHMS)
+	{
+		std::vector<std::string> hashes;
+		const auto task = engine.SubmitBuffer(data.data(), data.size(), 1000, Calculator::CreateHashCalculator(algorithm));
+		std::string digest;
+		while (task->Next(digest))
+			hashes.push_back(digest);
+		BOOST_CHECK_MESSAGE(hashes == Reference(path, 1000, *Calculator::CreateHashCalculator(algorithm)), "buffer " << algorithm);
+	}
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+BOOST_AUTO_TEST_CASE(stream_source_matches_reference)
+{
+	const Inputs & inputs = GeneratedInputs();
+	const std::string fifo = inputs.Path("fifo");
+	BOOST_REQUIRE_EQUAL(mkfifo(fifo.data(), 0600), 0);
+
+	for (const std::string & name : {std::string("random"), std::string("empty")})
+	{
+		const std::string path = inputs.Path(name);
+		// @note Writer gives up if reader does not open the pipe, so failed test does not hang.
+		std::thread writer([&fifo, &path]()
+		{
+			int fileDescriptor = -1;
+			for (int attempt = 0; attempt < 500 && fileDescriptor < 0; ++attempt)
+			{
+				fileDescriptor = open(fifo.data(), O_WRONLY | O_NONBLOCK);
+				if (fileDescriptor < 0)
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+			if (fileDescriptor < 0)
+				return;
+			fcntl(fileDescriptor, F_SETFL, 0);
+
+			std::ifstream file(path, std::ios_base::binary);
+			std::vector<char> chunk(MEGABYTE);
+			while (file.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || file.gcount() > 0)
+			{
+				const size_t size = static_cast<size_t>(file.gcount());
+				for (size_t written = 0; written < size; )
+				{
+					const ssize_t result = write(fileDescriptor, chunk.data() + written, size - written);
+					if (result <= 0)
+						break;
+					written += static_cast<size_t>(result);
+				}
+			}
+			close(fileDescriptor);
+		});
+
+		Calculator::CalculatorSettings settings;
+		settings.threads = 3;
+		const Calculator::DataProviderFactory factory = [&fifo]()
+		{
+			return Calculator::CreateDataProvider(Calculator::AvailableProviderTypes().front(), fifo);
+		};
+		const auto hashCalculator = std::make_shared<ThreadRecordingHashCalculator>(Calculator::CreateHashCalculator("md5"));
+		std::vector<std::string> hashes;
+		try
+		{
+			hashes = Calculate(factory, 65537, hashCalculator, settings);
+		}
+		catch (const std::exception & ex)
+		{
+			BOOST_ERROR("stream " << name << " failed: " << ex.what());
+		}
+		writer.join();
+		BOOST_CHECK_MESSAGE(hashes == Reference(path, 65537, *Calculator::CreateHashCalculator("md5")), "stream " << name);
+		// @note Size of stream is unknown, which must not limit it to single worker.
+		if (hashes.size() > 1)
+			BOOST_CHECK_MESSAGE(hashCalculator->Threads() > 1, "stream " << name << " is hashed by " << hashCalculator->Threads() << " worker");
+	}
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// @note Throughput depends on the host and its load, so the suite runs only when it is selected by --run_test.
+BOOST_AUTO_TEST_SUITE(throughput, * boost::unit_test::disabled())
+
+// @note First run of the build on the host records baseline. Later runs fail if throughput drops by more than threshold
+// (SIGNATURE_GENERATOR_REGRESSION_THRESHOLD, share of baseline). SIGNATURE_GENERATOR_UPDATE_BASELINE=1 records new one.
+BOOST_AUTO_TEST_CASE(throughput_is_not_below_baseline)
+{
+	const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("signature-throughput-%%%%-%%%%");
+	{
+		std::vector<char> data(THROUGHPUT_FILE_SIZE);
+		std::mt19937_64 generator(7);
+		std::generate(data.begin(), data.end(), [&generator]() { return static_cast<char>(generator()); });
+		std::ofstream(path.string(), std::ios_base::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+	}
+	struct FileRemover
+	{
+		const boost::filesystem::path & path;
+		~FileRemover() { boost::system::error_code error; boost::filesystem::remove(path, error); }
+	} remover {path};
+
+	const char * thresholdValue = std::getenv("SIGNATURE_GENERATOR_REGRESSION_THRESHOLD");
+	const double threshold = thresholdValue ? std::strtod(thresholdValue, nullptr) : DEFAULT_REGRESSION_THRESHOLD;
+	const char * updateValue = std::getenv("SIGNATURE_GENERATOR_UPDATE_BASELINE");
+	const bool update = updateValue != nullptr && std::string(updateValue) == "1";
+
+	const std::string baselinePath = BaselinePath();
+	std::map<std::string, double> baseline = LoadBaseline(baselinePath);
+	bool baselineChanged = false;
+
+	for (const std::string & algorithm : ALGORITHMS)
+	{
+		for (const Calculator::ProviderType type : Calculator::AvailableProviderTypes())
+		{
+			const Calculator::DataProviderFactory factory = [type, &path]()
+			{
+				return Calculator::CreateDataProvider(type, path.string());
+			};
+
+			// @note Best of several runs, data is in page cache after the first one.
+			double bestSpeed = 0;
+			for (int run = 0; run < THROUGHPUT_RUNS; ++run)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				Calculate(factory, THROUGHPUT_BLOCK_SIZE, algorithm, Calculator::CalculatorSettings());
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				bestSpeed = std::max(bestSpeed, static_cast<double>(THROUGHPUT_FILE_SIZE) / MEGABYTE / seconds);
+			}
+
+			const std::string key = "throughput." + BuildName() + "." + algorithm + "." + Calculator::ToString(type);
+			const auto it = baseline.find(key);
+			BOOST_TEST_MESSAGE(key << ": " << bestSpeed << " MB/s, baseline: " << (it != baseline.end() ? std::to_string(it->second) : "none"));
+			if (it == baseline.end() || update)
+			{
+				baseline[key] = bestSpeed;
+				baselineChanged = true;
+				continue;
+			}
+			BOOST_CHECK_MESSAGE(bestSpeed >= it->second * (1.0 - threshold),
+								key << " regressed: " << bestSpeed << " MB/s, baseline " << it->second << " MB/s (" << baselinePath << ")");
+		}
+	}
+
+	if (baselineChanged)
+		SaveBaseline(baselinePath, baseline);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "IHashCalculator.h"
+#include "Numa.h"
+#include "SignatureEngine.h"
+
+namespace
+{
+std::vector<std::uint8_t> MakeData(size_t size)
+{
+	std::vector<std::uint8_t> data(size);
+	std::uint32_t state = 12345;
+	for (std::uint8_t & byte : data)
+	{
+		state = state * 1103515245 + 12345;
+		byte = static_cast<std::uint8_t>(state >> 16);
+	}
+	return data;
+}
+
+std::vector<std::string> ExpectedDigests(const std::vector<std::uint8_t> & data, size_t blockSize, const std::string & algorithm)
+{
+	const std::shared_ptr<Hash::IHashCalculator> hasher = Calculator::CreateHashCalculator(algorithm);
+	std::vector<std::string> digests;
+	for (size_t from = 0; from < data.size(); from += blockSize)
+		digests.push_back(hasher->CalculateHash(data.data() + from, std::min(blockSize, data.size() - from)));
+	return digests;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(engine_buffer_digests_are_read_in_block_order)
+{
+	const std::vector<std::uint8_t> data = MakeData(1000003);
+	Calculator::SignatureEngine engine(3);
+	const std::unique_ptr<Calculator::SignatureTask> task = engine.SubmitBuffer(data.data(), data.size(), 4096, Calculator::CreateHashCalculator("md5"));
+
+	std::vector<std::string> digests;
+	std::string digest;
+	while (task->Next(digest))
+		digests.push_back(digest);
+
+	BOOST_CHECK(digests == ExpectedDigests(data, 4096, "md5"));
+	BOOST_CHECK(task->Finished());
+	BOOST_CHECK_EQUAL(task->Progress().hashedBlocks, digests.size());
+	BOOST_CHECK_EQUAL(task->Progress().totalBlocks, digests.size());
+}
+
+BOOST_AUTO_TEST_CASE(engine_tasks_share_workers_and_deliver_to_callbacks)
+{
+	const std::vector<std::uint8_t> first = MakeData(300000);
+	const std::vector<std::uint8_t> second = MakeData(77777);
+	Calculator::SignatureEngine engine(2);
+
+	// @note Callbacks are called by task threads, so checks are done after tasks are finished.
+	std::vector<std::string> firstDigests;
+	std::vector<std::string> secondDigests;
+	bool outOfOrder = false;
+	const auto collect = [&outOfOrder](std::vector<std::string> & to)
+	{
+		return [&to, &outOfOrder](std::uint64_t block, const std::string & digest)
+		{
+			if (block != to.size())
+				outOfOrder = true;
+			to.push_back(digest);
+		};
+	};
+	const std::unique_ptr<Calculator::SignatureTask> firstTask = engine.SubmitBuffer(first.data(), first.size(), 1000, Calculator::CreateHashCalculator("crc"), collect(firstDigests));
+	const std::unique_ptr<Calculator::SignatureTask> secondTask = engine.SubmitBuffer(second.data(), second.size(), 1000, Calculator::CreateHashCalculator("md5"), collect(secondDigests));
+	firstTask->Wait();
+	secondTask->Wait();
+
+	BOOST_CHECK(!outOfOrder);
+	BOOST_CHECK(firstDigests == ExpectedDigests(first, 1000, "crc"));
+	BOOST_CHECK(secondDigests == ExpectedDigests(second, 1000, "md5"));
+}
+
+BOOST_AUTO_TEST_CASE(engine_cancelled_task_stops_early)
+{
+	const std::vector<std::uint8_t> data = MakeData(4000000);
+	Calculator::SignatureEngine engine(2);
+	const std::unique_ptr<Calculator::SignatureTask> task = engine.SubmitBuffer(data.data(), data.size(), 16, Calculator::CreateHashCalculator("md5"));
+
+	std::string digest;
+	BOOST_REQUIRE(task->Next(digest));
+	task->Cancel();
+	BOOST_CHECK(!task->Next(digest));
+	BOOST_CHECK_NO_THROW(task->Wait());
+	BOOST_CHECK(task->Cancelled());
+	BOOST_CHECK(task->Progress().hashedBlocks < task->Progress().totalBlocks);
+}
+
+BOOST_AUTO_TEST_CASE(engine_reports_failure_of_callback)
+{
+	const std::vector<std::uint8_t> data = MakeData(10000);
+	Calculator::SignatureEngine engine(1);
+	const std::unique_ptr<Calculator::SignatureTask> task = engine.SubmitBuffer(data.data(), data.size(), 100, Calculator::CreateHashCalculator("crc"),
+		[](std::uint64_t block, const std::string &)
+		{
+			if (block == 10)
+				throw std::runtime_error("Callback failed.");
+		});
+
+	BOOST_CHECK_THROW(task->Wait(), std::runtime_error);
+	BOOST_CHECK_EQUAL(task->Progress().hashedBlocks, 10u);
+}
+
+BOOST_AUTO_TEST_CASE(engine_rejects_missing_file)
+{
+	Calculator::SignatureEngine engine(1);
+	BOOST_CHECK_THROW(engine.SubmitFile("/nonexistent/signature/input", 4096, Calculator::CreateHashCalculator("md5")), std::exception);
+	BOOST_CHECK_THROW(Calculator::CreateHashCalculator("sha1"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(numa_cpu_list_is_parsed)
+{
+	BOOST_CHECK(Calculator::ParseCpuList("0-3,8-11") == std::vector<int>({0, 1, 2, 3, 8, 9, 10, 11}));
+	BOOST_CHECK(Calculator::ParseCpuList("5") == std::vector<int>({5}));
+	BOOST_CHECK(Calculator::ParseCpuList("0,2-3\n") == std::vector<int>({0, 2, 3}));
+
+	// @note Node with memory only has empty cpu list.
+	BOOST_CHECK(Calculator::ParseCpuList("").empty());
+	BOOST_CHECK(Calculator::ParseCpuList("\n").empty());
+
+	BOOST_CHECK_THROW(Calculator::ParseCpuList("3-1"), std::invalid_argument);
+	BOOST_CHECK_THROW(Calculator::ParseCpuList("cpu"), std::invalid_argument);
+}
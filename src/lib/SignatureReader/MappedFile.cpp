@@ -0,0 +1,76 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <stdexcept>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Reader
+{
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+MappedFile::MappedFile(const std::string & path)
+{
+	const int fileDescriptor = open(path.data(), O_RDONLY);
+	if (fileDescriptor < 0)
+		throw std::runtime_error("Cannot open file: " + path + " with error: " + std::to_string(errno));
+
+	struct stat status {};
+	if (fstat(fileDescriptor, &status) != 0)
+	{
+		const int error = errno;
+		close(fileDescriptor);
+		throw std::runtime_error("Cannot get size of file: " + path + " with error: " + std::to_string(error));
+	}
+	m_size = static_cast<std::uint64_t>(status.st_size);
+
+	if (m_size > 0)
+	{
+		m_data = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+		const int error = errno;
+		if (m_data == MAP_FAILED)
+		{
+			m_data = nullptr;
+			close(fileDescriptor);
+			throw std::runtime_error("Cannot map file: " + path + " with error: " + std::to_string(error));
+		}
+		// @note Lookups touch few scattered pages, read ahead of neighbours would only waste page cache.
+		madvise(m_data, static_cast<size_t>(m_size), MADV_RANDOM);
+	}
+	close(fileDescriptor);
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_data != nullptr)
+		munmap(m_data, static_cast<size_t>(m_size));
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &)
+{
+	throw std::runtime_error("Mapping of signatures is not supported on this platform.");
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif
+
+const std::uint8_t * MappedFile::Data() const
+{
+	return static_cast<const std::uint8_t *>(m_data);
+}
+
+std::uint64_t MappedFile::Size() const
+{
+	return m_size;
+}
+
+} // namespace Reader
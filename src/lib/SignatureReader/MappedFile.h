@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef __APPLE__
+#define DLL_EXPORT
+#else
+#define DLL_EXPORT __declspec(dllexport)
+#endif
+
+namespace Reader
+{
+
+/// @brief Read only mapping of the whole file.
+/// @note Pages are loaded on first access, so only the looked up parts of big file are read from disk.
+class DLL_EXPORT MappedFile
+{
+public:
+	explicit MappedFile(const std::string & path);
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile & operator=(const MappedFile &) = delete;
+
+	/// @note nullptr for empty file.
+	const std::uint8_t * Data() const;
+	std::uint64_t Size() const;
+
+private:
+	void * m_data {nullptr};
+	std::uint64_t m_size {0};
+};
+
+} // namespace Reader
+
+#undef DLL_EXPORT
+
+#endif
@@ -0,0 +1,302 @@
+#include "SignatureIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+#include <boost/filesystem.hpp>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	#include <sys/stat.h>
+#endif
+
+#include "SignatureReader.h"
+
+namespace Reader
+{
+
+namespace
+{
+constexpr char MAGIC[] = {'S', 'I', 'G', 'I', 'D', 'X', '0', '2'};
+/// @note Magic followed by digest size, first block, number of blocks, size, modification time in nanoseconds and
+/// checksum of the first and the last pages of the signature.
+constexpr size_t HEADER_FIELDS = 6;
+/// @note Signature of the same size may be rewritten within timestamp granularity of file system, so its edges are
+/// compared too. Digests at both ends differ for different inputs, while reading them costs two pages.
+constexpr size_t CHECKSUM_BYTES = 4096;
+constexpr size_t HEADER_SIZE = sizeof(MAGIC) + HEADER_FIELDS * sizeof(std::uint64_t);
+constexpr size_t BLOCK_FIELD_SIZE = sizeof(std::uint64_t);
+/// @note Buffer of every run reader and of the output, merge of many runs should not multiply memory budget.
+constexpr size_t STREAM_BUFFER_SIZE = 65536;
+
+struct Record
+{
+	std::array<std::uint8_t, SignatureIndex::MAX_DIGEST_SIZE> digest {};
+	std::uint64_t block {0};
+
+	bool operator<(const Record & other) const { return std::tie(digest, block) < std::tie(other.digest, other.block); }
+	bool operator>(const Record & other) const { return other < *this; }
+};
+
+int HexValue(char symbol)
+{
+	if (symbol >= '0' && symbol <= '9')
+		return symbol - '0';
+	if (symbol >= 'a' && symbol <= 'f')
+		return symbol - 'a' + 10;
+	if (symbol >= 'A' && symbol <= 'F')
+		return symbol - 'A' + 10;
+	return -1;
+}
+
+void WriteUint64(std::ostream & stream, std::uint64_t value)
+{
+	char bytes[sizeof(value)];
+	for (size_t i = 0; i < sizeof(value); ++i)
+		bytes[i] = static_cast<char>(value >> (i * 8));
+	stream.write(bytes, sizeof(bytes));
+}
+
+std::uint64_t ReadUint64(const std::uint8_t * bytes)
+{
+	std::uint64_t value = 0;
+	for (size_t i = 0; i < sizeof(value); ++i)
+		value |= static_cast<std::uint64_t>(bytes[i]) << (i * 8);
+	return value;
+}
+
+void WriteRecord(std::ostream & stream, const Record & record, size_t digestSize)
+{
+	stream.write(reinterpret_cast<const char *>(record.digest.data()), static_cast<std::streamsize>(digestSize));
+	WriteUint64(stream, record.block);
+}
+
+bool ReadRecord(std::istream & stream, Record & record, size_t digestSize)
+{
+	std::uint8_t bytes[SignatureIndex::MAX_DIGEST_SIZE + BLOCK_FIELD_SIZE];
+	if (!stream.read(reinterpret_cast<char *>(bytes), static_cast<std::streamsize>(digestSize + BLOCK_FIELD_SIZE)))
+		return false;
+	std::memcpy(record.digest.data(), bytes, digestSize);
+	record.block = ReadUint64(bytes + digestSize);
+	return true;
+}
+
+std::uint64_t ModificationTime(const std::string & path)
+{
+#if defined(__linux__)
+	struct stat status {};
+	if (stat(path.data(), &status) != 0)
+		throw std::runtime_error("Cannot get modification time of file: " + path);
+	return static_cast<std::uint64_t>(status.st_mtim.tv_sec) * 1000000000 + static_cast<std::uint64_t>(status.st_mtim.tv_nsec);
+#elif defined(__APPLE__)
+	struct stat status {};
+	if (stat(path.data(), &status) != 0)
+		throw std::runtime_error("Cannot get modification time of file: " + path);
+	return static_cast<std::uint64_t>(status.st_mtimespec.tv_sec) * 1000000000 + static_cast<std::uint64_t>(status.st_mtimespec.tv_nsec);
+#else
+	return static_cast<std::uint64_t>(boost::filesystem::last_write_time(path)) * 1000000000;
+#endif
+}
+
+/// @brief FNV-1a of the first and the last CHECKSUM_BYTES of the signature.
+std::uint64_t EdgesChecksum(const SignatureReader & signature)
+{
+	std::uint64_t checksum = 14695981039346656037ull;
+	const auto add = [&checksum](std::string_view data)
+	{
+		for (const char symbol : data)
+		{
+			checksum ^= static_cast<std::uint8_t>(symbol);
+			checksum *= 1099511628211ull;
+		}
+	};
+	const std::string_view content = signature.Content();
+	add(content.substr(0, CHECKSUM_BYTES));
+	if (content.size() > CHECKSUM_BYTES)
+		add(content.substr(content.size() - std::min(CHECKSUM_BYTES, content.size() - CHECKSUM_BYTES)));
+	return checksum;
+}
+
+/// @brief Values of the header which must match the signature.
+std::array<std::uint64_t, HEADER_FIELDS> HeaderOf(const SignatureReader & signature)
+{
+	return {signature.DigestLength() / 2, signature.FirstBlock(), signature.EndBlock() - signature.FirstBlock(), signature.FileSize(),
+			ModificationTime(signature.Path()), EdgesChecksum(signature)};
+}
+
+/// @brief Removes spilled runs when index is built or failed.
+struct RunFiles
+{
+	~RunFiles()
+	{
+		boost::system::error_code error;
+		for (const std::string & path : paths)
+			boost::filesystem::remove(path, error);
+	}
+
+	std::vector<std::string> paths;
+};
+} // namespace
+
+void SignatureIndex::Build(const SignatureReader & signature, const std::string & indexPath, size_t memoryBudget, const std::string & tempDirectory)
+{
+	const size_t digestSize = signature.DigestLength() / 2;
+	const size_t recordsPerRun = std::max<size_t>(memoryBudget / sizeof(Record), 1);
+	const std::string directory = tempDirectory.empty() ? boost::filesystem::temp_directory_path().string() : tempDirectory;
+
+	std::vector<Record> run;
+	run.reserve(static_cast<size_t>(std::min<std::uint64_t>(recordsPerRun, signature.EndBlock() - signature.FirstBlock())));
+	RunFiles runFiles;
+
+	const auto spill = [&run, &runFiles, &directory, digestSize]()
+	{
+		std::sort(run.begin(), run.end());
+		runFiles.paths.push_back((boost::filesystem::path(directory) / boost::filesystem::unique_path("signature-index-%%%%-%%%%-%%%%")).string());
+		std::ofstream file(runFiles.paths.back(), std::ios_base::binary | std::ios_base::trunc);
+		for (const Record & record : run)
+			WriteRecord(file, record, digestSize);
+		if (!file.flush())
+			throw std::runtime_error("Cannot write run of index: " + runFiles.paths.back());
+		run.clear();
+	};
+
+	signature.ForEachDigest(signature.FirstBlock(), signature.EndBlock(), [&](std::uint64_t block, std::string_view digest)
+	{
+		Record record;
+		record.block = block;
+		if (!ParseDigest(digest, record.digest.data(), digestSize))
+			throw std::runtime_error("Signature: " + signature.Path() + " has broken digest of block " + std::to_string(block));
+		run.push_back(record);
+		if (run.size() == recordsPerRun)
+			spill();
+	});
+
+	// @note Index is written next to the final path and renamed, so readers never see half written index.
+	const std::string temporaryPath = indexPath + ".tmp";
+	{
+		std::vector<char> outputBuffer(STREAM_BUFFER_SIZE);
+		std::ofstream output;
+		output.rdbuf()->pubsetbuf(outputBuffer.data(), static_cast<std::streamsize>(outputBuffer.size()));
+		output.open(temporaryPath, std::ios_base::binary | std::ios_base::trunc);
+		if (!output.is_open())
+			throw std::runtime_error("Cannot open file: " + temporaryPath + "; for index output.");
+
+		output.write(MAGIC, sizeof(MAGIC));
+		for (const std::uint64_t value : HeaderOf(signature))
+			WriteUint64(output, value);
+
+		if (runFiles.paths.empty())
+		{
+			std::sort(run.begin(), run.end());
+			for (const Record & record : run)
+				WriteRecord(output, record, digestSize);
+		}
+		else
+		{
+			if (!run.empty())
+				spill();
+			std::vector<Record>().swap(run);
+
+			// @note K-way merge, the smallest head record of all runs goes to the output next.
+			std::vector<std::unique_ptr<std::ifstream>> runs;
+			std::vector<std::vector<char>> buffers(runFiles.paths.size(), std::vector<char>(STREAM_BUFFER_SIZE));
+			using Head = std::pair<Record, size_t>;
+			std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+			for (size_t i = 0; i < runFiles.paths.size(); ++i)
+			{
+				runs.push_back(std::make_unique<std::ifstream>());
+				runs.back()->rdbuf()->pubsetbuf(buffers[i].data(), static_cast<std::streamsize>(buffers[i].size()));
+				runs.back()->open(runFiles.paths[i], std::ios_base::binary);
+				Record record;
+				if (ReadRecord(*runs.back(), record, digestSize))
+					heads.emplace(record, i);
+			}
+			while (!heads.empty())
+			{
+				const auto [record, runIndex] = heads.top();
+				heads.pop();
+				WriteRecord(output, record, digestSize);
+				Record next;
+				if (ReadRecord(*runs[runIndex], next, digestSize))
+					heads.emplace(next, runIndex);
+			}
+		}
+
+		if (!output.flush())
+			throw std::runtime_error("Cannot write file: " + temporaryPath + "; for index output.");
+	}
+	boost::filesystem::rename(temporaryPath, indexPath);
+}
+
+bool SignatureIndex::ParseDigest(std::string_view hex, std::uint8_t * digest, size_t digestSize)
+{
+	if (hex.size() != digestSize * 2)
+		return false;
+
+	for (size_t i = 0; i < digestSize; ++i)
+	{
+		const int high = HexValue(hex[i * 2]);
+		const int low = HexValue(hex[i * 2 + 1]);
+		if (high < 0 || low < 0)
+			return false;
+		digest[i] = static_cast<std::uint8_t>((high << 4) | low);
+	}
+	return true;
+}
+
+SignatureIndex::SignatureIndex(const std::string & indexPath, const SignatureReader & signature)
+	: m_file(indexPath)
+	, m_digestSize(signature.DigestLength() / 2)
+{
+	if (m_file.Size() < HEADER_SIZE || std::memcmp(m_file.Data(), MAGIC, sizeof(MAGIC)) != 0)
+		throw std::runtime_error("File: " + indexPath + " is not signature index.");
+
+	const std::array<std::uint64_t, HEADER_FIELDS> expected = HeaderOf(signature);
+	for (size_t i = 0; i < HEADER_FIELDS; ++i)
+		if (ReadUint64(m_file.Data() + sizeof(MAGIC) + i * sizeof(std::uint64_t)) != expected[i])
+			throw std::runtime_error("Index: " + indexPath + " does not match signature: " + signature.Path());
+
+	const size_t recordSize = m_digestSize + BLOCK_FIELD_SIZE;
+	m_records = (m_file.Size() - HEADER_SIZE) / recordSize;
+	if ((m_file.Size() - HEADER_SIZE) % recordSize != 0 || m_records != expected[2])
+		throw std::runtime_error("Index: " + indexPath + " is truncated.");
+}
+
+std::vector<std::uint64_t> SignatureIndex::Find(const std::uint8_t * digest) const
+{
+	const size_t recordSize = m_digestSize + BLOCK_FIELD_SIZE;
+	const std::uint8_t * records = m_file.Data() + HEADER_SIZE;
+
+	// @note Binary search touches about log2(records) pages, the rest of index is never read.
+	std::uint64_t first = 0;
+	std::uint64_t count = m_records;
+	while (count > 0)
+	{
+		const std::uint64_t step = count / 2;
+		if (std::memcmp(records + (first + step) * recordSize, digest, m_digestSize) < 0)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+
+	std::vector<std::uint64_t> blocks;
+	for (std::uint64_t i = first; i < m_records && std::memcmp(records + i * recordSize, digest, m_digestSize) == 0; ++i)
+		blocks.push_back(ReadUint64(records + i * recordSize + m_digestSize));
+	return blocks;
+}
+
+std::uint64_t SignatureIndex::Records() const
+{
+	return m_records;
+}
+
+} // namespace Reader
@@ -0,0 +1,59 @@
+#ifndef SIGNATURE_INDEX_H
+#define SIGNATURE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+#ifdef __APPLE__
+#define DLL_EXPORT
+#else
+#define DLL_EXPORT __declspec(dllexport)
+#endif
+
+namespace Reader
+{
+
+class SignatureReader;
+
+/// @brief Sidecar file with binary digests of the signature sorted together with their block indexes.
+/// Header keeps size, modification time and checksum of both ends of the signature, so index of changed signature is not used.
+/// Records are binary digest followed by little endian 64 bit block index, ordered by digest and then by block.
+class DLL_EXPORT SignatureIndex
+{
+public:
+	static constexpr size_t MAX_DIGEST_SIZE = 16;
+	static constexpr size_t DEFAULT_MEMORY_BUDGET = 268435456;
+
+	/// @brief Writes index of the signature. Records are sorted in runs which fit into memory budget, runs are spilled
+	/// to temporary directory and merged, so signature of any size may be indexed.
+	/// @param tempDirectory directory for runs, system temporary directory is used if it is empty.
+	static void Build(const SignatureReader & signature, const std::string & indexPath, size_t memoryBudget = DEFAULT_MEMORY_BUDGET,
+					  const std::string & tempDirectory = std::string());
+
+	/// @brief Converts hex digest into bytes.
+	/// @return false if digest is not hex or its size is wrong.
+	static bool ParseDigest(std::string_view hex, std::uint8_t * digest, size_t digestSize);
+
+	/// @note Throws exception if file is not index of the signature.
+	SignatureIndex(const std::string & indexPath, const SignatureReader & signature);
+
+	/// @brief Returns ascending indexes of blocks with binary digest.
+	std::vector<std::uint64_t> Find(const std::uint8_t * digest) const;
+	std::uint64_t Records() const;
+
+private:
+	const MappedFile m_file;
+	size_t m_digestSize {0};
+	std::uint64_t m_records {0};
+};
+
+} // namespace Reader
+
+#undef DLL_EXPORT
+
+#endif
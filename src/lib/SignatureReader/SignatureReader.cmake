@@ -0,0 +1,20 @@
+add_library(SignatureReader SHARED "${CMAKE_CURRENT_LIST_DIR}/MappedFile.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/MappedFile.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/SignatureIndex.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/SignatureIndex.h"
+								   "${CMAKE_CURRENT_LIST_DIR}/SignatureReader.cpp"
+								   "${CMAKE_CURRENT_LIST_DIR}/SignatureReader.h")
+target_include_directories(SignatureReader INTERFACE "${CMAKE_CURRENT_LIST_DIR}")
+
+target_link_libraries(SignatureReader Boost::filesystem)
+
+add_executable(reader_test_suite "${CMAKE_CURRENT_LIST_DIR}/unit_tests/reader_test.cpp")
+
+target_compile_definitions(reader_test_suite PRIVATE BOOST_TEST_MAIN BOOST_TEST_DYN_LINK BOOST_TEST_MODULE=reader_test_suite)
+
+target_link_libraries(reader_test_suite Boost::unit_test_framework
+										Boost::filesystem
+										TestHelpers
+										SignatureReader)
+
+add_test(NAME reader_test_runner COMMAND reader_test_suite)
@@ -0,0 +1,174 @@
+#include "SignatureReader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "SignatureIndex.h"
+
+namespace Reader
+{
+
+namespace
+{
+const std::string SHARD_MARKER = "#shard";
+const std::string BLOCK_SIZE_FIELD = "block_size=";
+const std::string FIRST_BLOCK_FIELD = "first_block=";
+const std::string INDEX_EXTENSION = ".idx";
+} // namespace
+
+SignatureReader::SignatureReader(const std::string & path, size_t digestLength, std::uint64_t blockSize)
+	: m_path(path)
+	, m_digestLength(digestLength)
+	, m_file(path)
+	, m_blockSize(blockSize)
+{
+	if (m_digestLength < 2 || m_digestLength % 2 != 0 || m_digestLength > SignatureIndex::MAX_DIGEST_SIZE * 2)
+		throw std::invalid_argument("Invalid digest length.");
+
+	const char * data = reinterpret_cast<const char *>(m_file.Data());
+	const std::string_view content(data, static_cast<size_t>(m_file.Size()));
+	if (content.compare(0, SHARD_MARKER.size(), SHARD_MARKER) == 0)
+	{
+		const size_t headerEnd = content.find('\n');
+		if (headerEnd == std::string_view::npos)
+			throw std::runtime_error("Signature: " + m_path + " has broken shard header.");
+		m_payloadOffset = headerEnd + 1;
+
+		std::istringstream fields(std::string(content.substr(0, headerEnd)));
+		std::string field;
+		while (fields >> field)
+		{
+			if (field.compare(0, FIRST_BLOCK_FIELD.size(), FIRST_BLOCK_FIELD) == 0)
+				m_firstBlock = std::stoull(field.substr(FIRST_BLOCK_FIELD.size()));
+			else if (field.compare(0, BLOCK_SIZE_FIELD.size(), BLOCK_SIZE_FIELD) == 0)
+			{
+				const std::uint64_t shardBlockSize = std::stoull(field.substr(BLOCK_SIZE_FIELD.size()));
+				if (m_blockSize != 0 && m_blockSize != shardBlockSize)
+					throw std::invalid_argument("Signature: " + m_path + " was made with block size " + std::to_string(shardBlockSize));
+				m_blockSize = shardBlockSize;
+			}
+		}
+	}
+
+	const std::uint64_t payloadSize = m_file.Size() - m_payloadOffset;
+	if (payloadSize % m_digestLength != 0)
+		throw std::runtime_error("Signature: " + m_path + " is not made of digests of " + std::to_string(m_digestLength) + " symbols.");
+	m_blocks = payloadSize / m_digestLength;
+
+	// @note Index is optional, stale or broken one is not used and Find falls back to scan.
+	const std::string indexPath = IndexPath(m_path);
+	boost::system::error_code error;
+	if (boost::filesystem::exists(indexPath, error))
+	{
+		try
+		{
+			m_index = std::make_unique<SignatureIndex>(indexPath, *this);
+		}
+		catch (const std::exception &)
+		{
+			m_index.reset();
+		}
+	}
+}
+
+SignatureReader::~SignatureReader() = default;
+
+std::string SignatureReader::IndexPath(const std::string & signaturePath)
+{
+	return signaturePath + INDEX_EXTENSION;
+}
+
+const std::string & SignatureReader::Path() const
+{
+	return m_path;
+}
+
+size_t SignatureReader::DigestLength() const
+{
+	return m_digestLength;
+}
+
+std::uint64_t SignatureReader::BlockSize() const
+{
+	return m_blockSize;
+}
+
+std::uint64_t SignatureReader::FirstBlock() const
+{
+	return m_firstBlock;
+}
+
+std::uint64_t SignatureReader::EndBlock() const
+{
+	return m_firstBlock + m_blocks;
+}
+
+std::uint64_t SignatureReader::FileSize() const
+{
+	return m_file.Size();
+}
+
+std::string_view SignatureReader::Content() const
+{
+	return std::string_view(reinterpret_cast<const char *>(m_file.Data()), static_cast<size_t>(m_file.Size()));
+}
+
+std::string_view SignatureReader::Digest(std::uint64_t block) const
+{
+	if (block < m_firstBlock || block >= EndBlock())
+		throw std::out_of_range("Block " + std::to_string(block) + " is not in signature: " + m_path);
+
+	const char * data = reinterpret_cast<const char *>(m_file.Data());
+	return std::string_view(data + m_payloadOffset + (block - m_firstBlock) * m_digestLength, m_digestLength);
+}
+
+std::uint64_t SignatureReader::BlockAt(std::uint64_t offset) const
+{
+	if (m_blockSize == 0)
+		throw std::logic_error("Block size of signature: " + m_path + " is unknown.");
+	return offset / m_blockSize;
+}
+
+void SignatureReader::ForEachDigest(std::uint64_t firstBlock, std::uint64_t endBlock, const std::function<void(std::uint64_t, std::string_view)> & onDigest) const
+{
+	for (std::uint64_t block = std::max(firstBlock, m_firstBlock); block < std::min(endBlock, EndBlock()); ++block)
+		onDigest(block, Digest(block));
+}
+
+std::vector<std::uint64_t> SignatureReader::Find(const std::string & digest) const
+{
+	std::uint8_t bytes[SignatureIndex::MAX_DIGEST_SIZE] = {};
+	if (!SignatureIndex::ParseDigest(digest, bytes, m_digestLength / 2))
+		throw std::invalid_argument("Digest: " + digest + " is not hex digest of " + std::to_string(m_digestLength) + " symbols.");
+
+	if (m_index)
+		return m_index->Find(bytes);
+
+	// @note Hash calculators differ in case of hex symbols, so both spellings are compared.
+	std::string lower = digest;
+	std::string upper = digest;
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char symbol) { return static_cast<char>(std::tolower(symbol)); });
+	std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char symbol) { return static_cast<char>(std::toupper(symbol)); });
+
+	std::vector<std::uint64_t> blocks;
+	const std::uint8_t * payload = m_file.Data() + m_payloadOffset;
+	for (std::uint64_t i = 0; i < m_blocks; ++i)
+	{
+		const std::uint8_t * current = payload + i * m_digestLength;
+		if (std::memcmp(current, lower.data(), m_digestLength) == 0 || std::memcmp(current, upper.data(), m_digestLength) == 0)
+			blocks.push_back(m_firstBlock + i);
+	}
+	return blocks;
+}
+
+bool SignatureReader::Indexed() const
+{
+	return m_index != nullptr;
+}
+
+} // namespace Reader
@@ -0,0 +1,83 @@
+#ifndef SIGNATURE_READER_H
+#define SIGNATURE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+#ifdef __APPLE__
+#define DLL_EXPORT
+#else
+#define DLL_EXPORT __declspec(dllexport)
+#endif
+
+namespace Reader
+{
+
+class SignatureIndex;
+
+/// @brief Random access to digests of the signature without reading it whole.
+/// Signature is mapped into memory and position of every digest is computed from its block index, so lookups touch only
+/// pages holding requested digests. Shard signatures are accepted, block indexes are then counted from the first block
+/// of the shard.
+class DLL_EXPORT SignatureReader
+{
+public:
+	/// @param digestLength length of one hex digest in the signature.
+	/// @param blockSize block size signature was made with, 0 if it is unknown. Shard signatures take it from header and
+	/// throw exception if it differs from non zero blockSize.
+	/// @note Sorted index is used by Find if it is placed next to signature (see IndexPath) and matches it.
+	SignatureReader(const std::string & path, size_t digestLength, std::uint64_t blockSize = 0);
+	~SignatureReader();
+
+	/// @brief Path of the sorted index of the signature.
+	static std::string IndexPath(const std::string & signaturePath);
+
+	const std::string & Path() const;
+	size_t DigestLength() const;
+	/// @note 0 if it is unknown.
+	std::uint64_t BlockSize() const;
+	/// @brief Signature holds digests of blocks [FirstBlock(), EndBlock()).
+	std::uint64_t FirstBlock() const;
+	std::uint64_t EndBlock() const;
+	/// @brief Size of the signature file.
+	std::uint64_t FileSize() const;
+	/// @brief Whole signature file including shard header, valid while reader exists.
+	std::string_view Content() const;
+
+	/// @note Throws exception if block is out of signature. Returned digest stays valid while reader exists.
+	std::string_view Digest(std::uint64_t block) const;
+	/// @brief Returns index of the block holding byte at offset of the hashed input.
+	/// @note Throws exception if block size is unknown.
+	std::uint64_t BlockAt(std::uint64_t offset) const;
+	/// @brief Calls onDigest for blocks [firstBlock, endBlock) which are present in signature.
+	void ForEachDigest(std::uint64_t firstBlock, std::uint64_t endBlock, const std::function<void(std::uint64_t block, std::string_view digest)> & onDigest) const;
+
+	/// @brief Returns ascending indexes of blocks with the digest, digest case does not matter.
+	/// @note Without index the whole signature is scanned, though still without parsing it.
+	std::vector<std::uint64_t> Find(const std::string & digest) const;
+	bool Indexed() const;
+
+private:
+	const std::string m_path;
+	const size_t m_digestLength;
+	const MappedFile m_file;
+	std::uint64_t m_blockSize {0};
+	/// @note Position of the first digest, non-zero for shard signatures.
+	std::uint64_t m_payloadOffset {0};
+	std::uint64_t m_firstBlock {0};
+	std::uint64_t m_blocks {0};
+	std::unique_ptr<SignatureIndex> m_index;
+};
+
+} // namespace Reader
+
+#undef DLL_EXPORT
+
+#endif
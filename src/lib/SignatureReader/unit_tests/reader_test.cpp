@@ -0,0 +1,130 @@
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "SignatureIndex.h"
+#include "SignatureReader.h"
+
+#include "TestFiles.h"
+
+namespace
+{
+using TestHelpers::SignatureFile;
+
+const std::string A = "0123456789abcdef0123456789abcdef";
+const std::string B = "fedcba9876543210fedcba9876543210";
+const std::string C = "00000000000000000000000000000001";
+
+std::string Crc(std::uint32_t value)
+{
+	static const char SYMBOLS[] = "0123456789abcdef";
+	std::string hex(8, '0');
+	for (size_t i = 0; i < hex.size(); ++i)
+		hex[i] = SYMBOLS[(value >> ((7 - i) * 4)) & 0x0F];
+	return hex;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(digest_by_block_and_offset)
+{
+	const SignatureFile signature(A + B + C);
+	const Reader::SignatureReader reader(signature.path, A.size(), 4096);
+
+	BOOST_CHECK_EQUAL(reader.FirstBlock(), 0u);
+	BOOST_CHECK_EQUAL(reader.EndBlock(), 3u);
+	BOOST_CHECK_EQUAL(reader.Digest(1), B);
+	BOOST_CHECK_EQUAL(reader.Digest(reader.BlockAt(4095)), A);
+	BOOST_CHECK_EQUAL(reader.Digest(reader.BlockAt(8192)), C);
+	BOOST_CHECK_THROW(reader.Digest(3), std::out_of_range);
+
+	std::vector<std::uint64_t> blocks;
+	reader.ForEachDigest(1, 10, [&blocks](std::uint64_t block, std::string_view) { blocks.push_back(block); });
+	BOOST_CHECK((blocks == std::vector<std::uint64_t> {1, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(shard_signature_uses_header)
+{
+	const SignatureFile signature("#shard algorithm=md5 block_size=1000 first_block=10 block_count=2 total_blocks=20\n" + B + C);
+	const Reader::SignatureReader reader(signature.path, A.size());
+
+	BOOST_CHECK_EQUAL(reader.BlockSize(), 1000u);
+	BOOST_CHECK_EQUAL(reader.FirstBlock(), 10u);
+	BOOST_CHECK_EQUAL(reader.EndBlock(), 12u);
+	BOOST_CHECK_EQUAL(reader.Digest(reader.BlockAt(11999)), C);
+	BOOST_CHECK_THROW(reader.Digest(9), std::out_of_range);
+	BOOST_CHECK_THROW(Reader::SignatureReader(signature.path, A.size(), 4096), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(unknown_block_size_and_broken_signature)
+{
+	const SignatureFile signature(A + B.substr(1));
+	BOOST_CHECK_THROW(Reader::SignatureReader(signature.path, A.size()), std::runtime_error);
+
+	const SignatureFile valid(A);
+	const Reader::SignatureReader reader(valid.path, A.size());
+	BOOST_CHECK_THROW(reader.BlockAt(0), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(find_with_and_without_index)
+{
+	std::string content;
+	for (std::uint32_t i = 0; i < 1000; ++i)
+		content += Crc(i % 7 == 0 ? 0xdeadbeef : i);
+	const SignatureFile signature(content);
+
+	std::vector<std::uint64_t> expected;
+	for (std::uint64_t i = 0; i < 1000; i += 7)
+		expected.push_back(i);
+
+	const Reader::SignatureReader scanning(signature.path, 8);
+	BOOST_CHECK(!scanning.Indexed());
+	BOOST_CHECK(scanning.Find("DEADBEEF") == expected);
+	BOOST_CHECK(scanning.Find("00000001") == std::vector<std::uint64_t> {1});
+	BOOST_CHECK(scanning.Find("00000007").empty());
+	BOOST_CHECK_THROW(scanning.Find("xyz"), std::invalid_argument);
+
+	// @note Small memory budget makes many runs, so merge of runs is tested too.
+	Reader::SignatureIndex::Build(scanning, Reader::SignatureReader::IndexPath(signature.path), 1000);
+	const Reader::SignatureReader indexed(signature.path, 8);
+	BOOST_REQUIRE(indexed.Indexed());
+	BOOST_CHECK(indexed.Find("deadbeef") == expected);
+	BOOST_CHECK(indexed.Find("00000001") == std::vector<std::uint64_t> {1});
+	BOOST_CHECK(indexed.Find("00000007").empty());
+	BOOST_CHECK(indexed.Find("ffffffff").empty());
+}
+
+BOOST_AUTO_TEST_CASE(stale_index_is_not_used)
+{
+	const SignatureFile signature(A + B + A);
+	{
+		const Reader::SignatureReader reader(signature.path, A.size());
+		Reader::SignatureIndex::Build(reader, Reader::SignatureReader::IndexPath(signature.path));
+	}
+	std::ofstream(signature.path, std::ios_base::binary | std::ios_base::app) << C;
+
+	const Reader::SignatureReader reader(signature.path, A.size());
+	BOOST_CHECK(!reader.Indexed());
+	BOOST_CHECK(reader.Find(A) == (std::vector<std::uint64_t> {0, 2}));
+	BOOST_CHECK(reader.Find(C) == std::vector<std::uint64_t> {3});
+}
+
+BOOST_AUTO_TEST_CASE(index_of_rewritten_signature_of_the_same_size_is_not_used)
+{
+	// @note Signature of another input of the same size is written right after index, usually within the same second.
+	const SignatureFile signature(A + B + A);
+	{
+		const Reader::SignatureReader reader(signature.path, A.size());
+		Reader::SignatureIndex::Build(reader, Reader::SignatureReader::IndexPath(signature.path));
+	}
+	std::ofstream(signature.path, std::ios_base::binary | std::ios_base::trunc) << C + B + C;
+
+	const Reader::SignatureReader reader(signature.path, A.size());
+	BOOST_CHECK(!reader.Indexed());
+	BOOST_CHECK(reader.Find(A).empty());
+	BOOST_CHECK(reader.Find(C) == (std::vector<std::uint64_t> {0, 2}));
+}
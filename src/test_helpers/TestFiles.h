@@ -0,0 +1,71 @@
+#ifndef TEST_FILES_H
+#define TEST_FILES_H
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+/// @note Files of unit tests, shared by suites of all libraries and of the application.
+namespace TestHelpers
+{
+
+/// @brief Unique directory in temporary directory, removed with everything inside it.
+struct TemporaryDirectory
+{
+	explicit TemporaryDirectory(const std::string & prefix = "signature-test")
+		: path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path(prefix + "-%%%%-%%%%"))
+	{
+		boost::filesystem::create_directories(path);
+	}
+	~TemporaryDirectory()
+	{
+		boost::system::error_code error;
+		boost::filesystem::remove_all(path, error);
+	}
+
+	TemporaryDirectory(const TemporaryDirectory &) = delete;
+	TemporaryDirectory & operator=(const TemporaryDirectory &) = delete;
+
+	std::string File(const std::string & name) const { return (path / name).string(); }
+
+	const boost::filesystem::path path;
+};
+
+/// @brief Signature file with given content. Files placed next to it (e.g. index) are removed with it.
+struct SignatureFile
+{
+	explicit SignatureFile(const std::string & content, const std::string & prefix = "signature-test")
+		: directory(prefix)
+		, path(directory.File("signature"))
+	{
+		std::ofstream(path, std::ios_base::binary) << content;
+	}
+
+	const TemporaryDirectory directory;
+	const std::string path;
+};
+
+inline std::string ReadFile(const std::string & path)
+{
+	std::ifstream file(path, std::ios_base::binary);
+	return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+/// @brief Writes size pseudo random bytes, the same seed gives the same content.
+inline std::string WriteRandomFile(const std::string & path, size_t size, unsigned int seed)
+{
+	std::vector<char> data(size);
+	std::mt19937 generator(seed);
+	for (char & byte : data)
+		byte = static_cast<char>(generator());
+	std::ofstream(path, std::ios_base::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+	return path;
+}
+
+} // namespace TestHelpers
+
+#endif
@@ -0,0 +1,4 @@
+# @note Header only helpers of unit tests.
+add_library(TestHelpers INTERFACE)
+target_include_directories(TestHelpers INTERFACE "${SRC_DIR}/test_helpers")
+target_link_libraries(TestHelpers INTERFACE Boost::filesystem)